@@ -0,0 +1,63 @@
+# Benchmarks of the simulation and geometry code, without display:
+#   drones_bench [--budget seconds] [--max size] [--filter name] [--threads n]
+# prints one CSV line per benchmark and input size on the standard output.
+#   drones_bench --check
+# runs the correctness checks of the geometry code and of the flight kernels instead, exit code 1 on a failure.
+
+QT       += core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG(release, debug|release): DEFINES += QT_NO_DEBUG_OUTPUT QT_NO_INFO_OUTPUT
+
+TARGET = drones_bench
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    selfcheck.cpp \
+    ../canvas.cpp \
+    ../delaunaytriangulation.cpp \
+    ../determinant.cpp \
+    ../divideconquerdelaunay.cpp \
+    ../drone.cpp \
+    ../droneevents.cpp \
+    ../dronefleet.cpp \
+    ../dronekernel.cpp \
+    ../logging.cpp \
+    ../mypolygon.cpp \
+    ../predicates.cpp \
+    ../profiler.cpp \
+    ../server.cpp \
+    ../spatialgrid.cpp \
+    ../spriteatlas.cpp \
+    ../triangle.cpp \
+    ../vector2d.cpp \
+    ../viewportindex.cpp \
+    ../voronoi.cpp \
+    ../workerpool.cpp
+HEADERS += \
+    selfcheck.h \
+    ../canvas.h \
+    ../delaunaytriangulation.h \
+    ../determinant.h \
+    ../divideconquerdelaunay.h \
+    ../drone.h \
+    ../droneevents.h \
+    ../dronefleet.h \
+    ../dronekernel.h \
+    ../logging.h \
+    ../mypolygon.h \
+    ../predicates.h \
+    ../profiler.h \
+    ../server.h \
+    ../spatialgrid.h \
+    ../spriteatlas.h \
+    ../trajectoryreader.h \
+    ../trajectoryrecorder.h \
+    ../triangle.h \
+    ../vector2d.h \
+    ../viewportindex.h \
+    ../voronoi.h \
+    ../workerpool.h
@@ -0,0 +1,288 @@
+/**
+ * @file main.cpp
+ * @brief Benchmarks of the simulation, collision, triangulation and Voronoi code.
+ *
+ * Each benchmark is run on synthetic inputs from 10 to 1M elements (1-3-10 progression).
+ * The sizes of a benchmark stop growing when one run exceeds the time budget, since most
+ * of the geometry code is quadratic or worse. The results are printed as CSV on the standard
+ * output, one line per benchmark and size:
+ *
+ *     benchmark,size,threads,iterations,seconds_per_iteration,items_per_second
+ *
+ * The parallel triangulation is run with 1, 2, 4... threads up to the number of cores (or --threads):
+ * its speedup is the ratio of the items_per_second of a thread count to the one of a single thread.
+ *
+ * With --check, the correctness checks of SelfCheck are run instead of the benchmarks, and the
+ * exit code is 1 if one of them fails.
+ *
+ * The lines starting with # are comments (configuration, skipped sizes, kernel accuracy).
+ * The widgets are created on the offscreen platform, so no display is needed.
+ */
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+#include "canvas.h"
+#include "delaunaytriangulation.h"
+#include "dronefleet.h"
+#include "mypolygon.h"
+#include "predicates.h"
+#include "selfcheck.h"
+#include "server.h"
+#include "spatialgrid.h"
+#include "workerpool.h"
+
+static QTextStream out(stdout);
+static volatile int sink; ///< keeps the results of the measured code alive
+
+/**
+ * @brief Options of the command line
+ */
+struct BenchOptions {
+    double budget=1.0;    ///< maximum duration of one run before stopping to grow the size (s)
+    double minTime=0.2;   ///< minimum measured time of a size (s)
+    int maxSize=1000000;  ///< largest size
+    int threads=0;        ///< threads of the fleet, 0 for the number of cores
+    QString filter;       ///< run only the benchmarks whose name contains it
+};
+
+/**
+ * @brief A benchmark: prepare(n) builds the input of size n (not measured), run() is measured
+ */
+struct Benchmark {
+    const char *name;
+    std::function<void(int)> prepare;
+    std::function<void()> run;
+};
+
+// the geometry code traces every step: keep the output readable and the timings honest
+static void quietMessageHandler(QtMsgType type,const QMessageLogContext &,const QString &msg) {
+    if (type!=QtDebugMsg && type!=QtInfoMsg) {
+        QTextStream(stderr) << msg << Qt::endl;
+    }
+}
+
+static QVector<int> sizes(int maxSize) {
+    QVector<int> tab;
+    for (qint64 decade=10; decade<=maxSize; decade*=10) {
+        tab.append(int(decade));
+        if (3*decade<=maxSize) tab.append(int(3*decade));
+    }
+    return tab;
+}
+
+static void runBenchmark(const Benchmark &b,const BenchOptions &opt,int threads) {
+    for (int n:sizes(opt.maxSize)) {
+        int iterations=0;
+        qint64 total=0;
+        while (total<opt.minTime*1e9) {
+            b.prepare(n);
+            QElapsedTimer timer;
+            timer.start();
+            b.run();
+            total+=timer.nsecsElapsed();
+            iterations++;
+            if (total>opt.budget*1e9) break;
+        }
+        const double perIteration=total*1e-9/iterations;
+        out << b.name << ',' << n << ',' << threads << ',' << iterations << ','
+            << QString::number(perIteration,'g',6) << ',' << QString::number(n/perIteration,'g',6) << Qt::endl;
+        if (perIteration>opt.budget) {
+            out << "# " << b.name << ": sizes above " << n << " skipped (budget " << opt.budget << " s)" << Qt::endl;
+            break;
+        }
+    }
+}
+
+//-------------------------------------
+// inputs
+
+static std::mt19937 gen(12345);
+
+/**
+ * @brief n random points in a square whose area grows with n (constant density)
+ */
+static QVector<Vector2D> randomPoints(int n,float spacing) {
+    const float side=spacing*std::sqrt(float(n));
+    std::uniform_real_distribution<float> coord(0,side);
+    QVector<Vector2D> tab;
+    tab.reserve(n);
+    for (int i=0; i<n; i++) tab.append(Vector2D(coord(gen),coord(gen)));
+    return tab;
+}
+
+/**
+ * @brief Triangulation of a square with n interior points, as built by MainWindow
+ */
+static MyPolygon *buildTriangulation(int n) {
+    const float side=100.0f*std::sqrt(float(n));
+    MyPolygon *polygon=new MyPolygon(4);
+    polygon->addVertex(0,0);
+    polygon->addVertex(side,0);
+    polygon->addVertex(side,side);
+    polygon->addVertex(0,side);
+    std::uniform_real_distribution<float> coord(1,side-1);
+    for (int i=0; i<n; i++) polygon->addInteriorPoint(Vector2D(coord(gen),coord(gen)));
+    polygon->earClippingTriangulate();
+    return polygon;
+}
+
+/**
+ * @brief Triangulation of the servers as built by MainWindow before the Delaunay triangulation:
+ * convex hull, ear clipping of the hull, then insertion of the interior points (not Delaunay)
+ */
+static void legacyTriangulation(const QVector<Vector2D> &points) {
+    MyPolygon polygon(points.size());
+    for (const Vector2D &p:points) polygon.addVertex(p.x,p.y);
+    polygon.computeConvexHull();
+    const QVector<Vector2D> hullPoints=polygon.getHullVertices();
+    for (const Vector2D &p:points) {
+        if (!hullPoints.contains(p)) polygon.addInteriorPoint(p);
+    }
+    polygon.earClippingTriangulate();
+    polygon.integrateInteriorPoints();
+    sink=Triangle::triangles.size();
+}
+
+int main(int argc,char *argv[]) {
+    // no display needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM","offscreen");
+    QApplication app(argc,argv);
+    qInstallMessageHandler(quietMessageHandler);
+
+    BenchOptions opt;
+    const QStringList args=app.arguments();
+    if (args.contains("--check")) return SelfCheck::run(out)>0?1:0;
+    for (int i=1; i<args.size()-1; i++) {
+        if (args[i]=="--budget") opt.budget=args[++i].toDouble();
+        else if (args[i]=="--max") opt.maxSize=args[++i].toInt();
+        else if (args[i]=="--threads") opt.threads=args[++i].toInt();
+        else if (args[i]=="--filter") opt.filter=args[++i];
+    }
+
+    // kernel report
+    const DroneKernel::Isa isa=DroneKernel::detect();
+    out << "# flight kernel: " << DroneKernel::name(isa) << Qt::endl;
+    if (isa!=DroneKernel::scalar) {
+        DroneFleet::KernelAccuracy acc=DroneFleet::checkKernelAccuracy(isa);
+        out << "# kernel max errors: position " << acc.position << ", speed " << acc.speed
+            << ", azimut " << acc.azimut << ", status mismatches " << acc.statusMismatches << Qt::endl;
+    }
+    out << "benchmark,size,threads,iterations,seconds_per_iteration,items_per_second" << Qt::endl;
+
+    DroneFleet fleet;
+    fleet.setThreadCount(opt.threads);
+    SpatialGrid grid;
+    DelaunayTriangulation mesh;
+    WorkerPool meshPool(1);
+    QVector<Vector2D> points;
+    MyPolygon *polygon=nullptr;
+    Canvas canvas;
+    QVector<Server*> servers;
+    const float collisionDistance=96;
+
+    auto resetPolygon=[&](MyPolygon *p) { delete polygon; polygon=p; };
+    auto prepareTriangulation=[&](int n) {
+        resetPolygon(buildTriangulation(n));
+        polygon->integrateInteriorPoints();
+    };
+
+    const QVector<Benchmark> benchmarks={
+        // one step of a fleet of flying drones, items: drones
+        {"fleet_step",[&](int n) {
+             fleet.clear();
+             fleet.reserve(n);
+             const QVector<Vector2D> start=randomPoints(n,collisionDistance);
+             const QVector<Vector2D> goal=randomPoints(n,collisionDistance);
+             for (int i=0; i<n; i++) {
+                 fleet.add(QString::number(i),start[i]);
+                 fleet.setGoalPosition(i,goal[i]);
+                 fleet.start(i);
+             }
+             // end of the takeoff
+             for (int s=0; s<int(DroneModel::hoveringHeight/DroneModel::takeoffSpeed/0.02)+1; s++) fleet.step(0.02,collisionDistance);
+         },[&]() { fleet.step(0.02,collisionDistance); }},
+        // broad phase and neighbor pairs of n points, items: points
+        {"collision_grid",[&](int n) {
+             grid.clear();
+             points=randomPoints(n,collisionDistance);
+         },[&]() {
+             grid.setCellSize(collisionDistance);
+             for (int i=0; i<points.size(); i++) grid.update(i,points[i].x,points[i].y);
+             int close=0;
+             for (const Vector2D &p:points) {
+                 grid.forEachNeighbor(p.x,p.y,[&](int j) {
+                     if ((points[j]-p).length()<collisionDistance) close++;
+                 });
+             }
+             sink=close;
+         }},
+        // ear clipping of a convex polygon, items: vertices
+        {"ear_clipping",[&](int n) {
+             resetPolygon(new MyPolygon(n));
+             for (int i=0; i<n; i++) {
+                 const double a=2*M_PI*i/n;
+                 polygon->addVertex(1000*std::cos(a),1000*std::sin(a));
+             }
+         },[&]() { polygon->earClippingTriangulate(); }},
+        // insertion of interior points in the triangulation of a square, items: points
+        {"interior_points",[&](int n) { resetPolygon(buildTriangulation(n)); },
+         [&]() { polygon->integrateInteriorPoints(); }},
+        // local Delaunay certification of all the triangles, items: interior points
+        {"check_delaunay",prepareTriangulation,[&]() {
+             Triangle::resetCertification(Triangle::triangles);
+             canvas.checkDelaunay();
+         }},
+        // test of all the triangles against all the vertices, items: interior points
+        {"validate_delaunay",prepareTriangulation,[&]() { canvas.validateDelaunay(); }},
+        // flips until the triangulation is Delaunay, items: interior points
+        {"flip_all",prepareTriangulation,[&]() { canvas.flippAll(); }},
+        // triangulation of the servers of a configuration, items: points
+        {"triangulation_legacy",[&](int n) { points=randomPoints(n,100); },
+         [&]() { legacyTriangulation(points); }},
+        {"triangulation_delaunay",[&](int n) { points=randomPoints(n,100); },
+         [&]() {
+             mesh.build(points);
+             sink=mesh.getFaces().size();
+         }},
+        {"triangulation_dc",[&](int n) { points=randomPoints(n,100); },
+         [&]() {
+             mesh.buildDivideAndConquer(points,meshPool);
+             sink=mesh.getFaces().size();
+         }},
+        // Voronoi edges of one server per vertex, items: interior points
+        {"voronoi",[&](int n) {
+             prepareTriangulation(n);
+             qDeleteAll(servers);
+             servers.clear();
+             for (const Vector2D &p:polygon->interiorPoints) servers.append(new Server("S",p,"#FF0000"));
+             canvas.setServers(servers);
+         },[&]() { canvas.generateVoronoi(); }},
+    };
+
+    for (const Benchmark &b:benchmarks) {
+        if (!opt.filter.isEmpty() && !QString(b.name).contains(opt.filter)) continue;
+        if (QString(b.name)=="triangulation_dc") {
+            int maxThreads=opt.threads>0?opt.threads:int(std::thread::hardware_concurrency());
+            if (maxThreads<1) maxThreads=1;
+            for (int t=1; ; t=qMin(2*t,maxThreads)) {
+                meshPool.setThreadCount(t);
+                runBenchmark(b,opt,t);
+                if (t==maxThreads) break;
+            }
+            continue;
+        }
+        runBenchmark(b,opt,QString(b.name)=="fleet_step"?fleet.getThreadCount():1);
+    }
+    // the filter of the predicates should make the exact evaluations rare
+    out << "# exact predicate evaluations: " << Predicates::getExactCount() << Qt::endl;
+
+    canvas.setServers({});
+    qDeleteAll(servers);
+    delete polygon;
+    return 0;
+}
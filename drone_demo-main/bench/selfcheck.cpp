@@ -0,0 +1,363 @@
+#include "selfcheck.h"
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include "delaunaytriangulation.h"
+#include "dronefleet.h"
+#include "predicates.h"
+#include "triangle.h"
+#include "workerpool.h"
+
+typedef QVector<DelaunayTriangulation::Face> Faces;
+
+static std::mt19937 gen(2024);
+
+//-------------------------------------
+// inputs
+
+static QVector<Vector2D> randomPoints(int n,float side) {
+    std::uniform_real_distribution<float> coord(0,side);
+    QVector<Vector2D> tab;
+    for (int i=0; i<n; i++) tab.append(Vector2D(coord(gen),coord(gen)));
+    return tab;
+}
+
+/**
+ * @brief n integer points in [0,w]x[0,h]: many collinear, cocircular and duplicate points
+ */
+static QVector<Vector2D> integerPoints(int n,int w,int h) {
+    std::uniform_int_distribution<int> x(0,w),y(0,h);
+    QVector<Vector2D> tab;
+    for (int i=0; i<n; i++) tab.append(Vector2D(x(gen),y(gen)));
+    return tab;
+}
+
+static QVector<Vector2D> gridPoints(int side,float step) {
+    QVector<Vector2D> tab;
+    for (int i=0; i<side; i++) {
+        for (int j=0; j<side; j++) tab.append(Vector2D(i*step,j*step));
+    }
+    return tab;
+}
+
+static QVector<Vector2D> circlePoints(int n,float radius) {
+    QVector<Vector2D> tab;
+    for (int i=0; i<n; i++) tab.append(Vector2D(radius*std::cos(2*M_PI*i/n),radius*std::sin(2*M_PI*i/n)));
+    tab.append(Vector2D(0,0));
+    return tab;
+}
+
+//-------------------------------------
+// properties of a triangulation
+
+/**
+ * @brief Area of the convex hull of the points (monotone chain)
+ */
+static double hullArea(QVector<Vector2D> points) {
+    std::sort(points.begin(),points.end(),[](const Vector2D &a,const Vector2D &b) {
+        return a.x<b.x || (a.x==b.x && a.y<b.y);
+    });
+    QVector<Vector2D> hull;
+    for (int pass=0; pass<2; pass++) {
+        const int start=hull.size();
+        for (const Vector2D &p:points) {
+            while (hull.size()>=start+2 && Predicates::orient2d(hull[hull.size()-2],hull.last(),p)<=0) hull.removeLast();
+            hull.append(p);
+        }
+        hull.removeLast();
+        std::reverse(points.begin(),points.end());
+    }
+    double area=0;
+    for (int i=0; i<hull.size(); i++) {
+        const Vector2D &a=hull[i],&b=hull[(i+1)%hull.size()];
+        area+=double(a.x)*b.y-double(b.x)*a.y;
+    }
+    return area/2;
+}
+
+/**
+ * @brief Check a triangulation of the convex hull of the distinct vertices
+ *
+ * The faces must be counterclockwise with symmetric neighbors, cover the hull exactly (same area,
+ * 2n-2-h faces for n distinct vertices and h hull edges) and have empty circumcircles: the local
+ * test across each edge, and the test against all the vertices for small inputs.
+ * @return the errors found, empty if the triangulation is correct
+ */
+static QStringList checkMesh(const QVector<Vector2D> &vertices,const Faces &faces,int duplicates) {
+    QStringList errors;
+    const double hull=hullArea(vertices);
+    if (faces.isEmpty()) {
+        if (hull!=0) errors << QString("no face for a hull of area %1").arg(hull);
+        return errors;
+    }
+    int hullEdges=0;
+    double area=0;
+    for (int f=0; f<faces.size() && errors.size()<5; f++) {
+        const DelaunayTriangulation::Face &face=faces[f];
+        const Vector2D &a=vertices[face.v[0]],&b=vertices[face.v[1]],&c=vertices[face.v[2]];
+        const double o=Predicates::orient2d(a,b,c);
+        if (o<=0) errors << QString("face %1 is not counterclockwise").arg(f);
+        area+=o/2;
+        for (int k=0; k<3; k++) {
+            const int g=face.n[k];
+            if (g<0) {
+                hullEdges++;
+                continue;
+            }
+            int m=0;
+            while (m<3 && faces[g].n[m]!=f) m++;
+            if (m==3 || faces[g].v[(m+1)%3]!=face.v[(k+2)%3] || faces[g].v[(m+2)%3]!=face.v[(k+1)%3]) {
+                errors << QString("faces %1 and %2 are not symmetric neighbors").arg(f).arg(g);
+            } else if (Predicates::incircle(a,b,c,vertices[faces[g].v[m]])>0) {
+                errors << QString("face %1 has the vertex %2 in its circumcircle").arg(f).arg(faces[g].v[m]);
+            }
+        }
+    }
+    const int n=vertices.size()-duplicates;
+    if (faces.size()!=2*n-2-hullEdges) {
+        errors << QString("%1 faces instead of %2").arg(faces.size()).arg(2*n-2-hullEdges);
+    }
+    if (std::fabs(area-hull)>1e-9*qMax(hull,1.0)) errors << QString("area %1 instead of the hull area %2").arg(area).arg(hull);
+    if (errors.isEmpty() && vertices.size()<=2000) {
+        for (int f=0; f<faces.size() && errors.isEmpty(); f++) {
+            const DelaunayTriangulation::Face &face=faces[f];
+            for (int v=0; v<vertices.size(); v++) {
+                if (Predicates::incircle(vertices[face.v[0]],vertices[face.v[1]],vertices[face.v[2]],vertices[v])>0) {
+                    errors << QString("face %1 has the vertex %2 in its circumcircle").arg(f).arg(v);
+                    break;
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief Triangles of the faces of a mesh, in the same order and not linked
+ */
+static QVector<Triangle> toTriangles(DelaunayTriangulation &mesh) {
+    QVector<Triangle> triangles;
+    for (const DelaunayTriangulation::Face &f:mesh.getFaces()) {
+        triangles.append(Triangle(mesh.getVertexPtr(f.v[0]),mesh.getVertexPtr(f.v[1]),mesh.getVertexPtr(f.v[2]),Qt::yellow));
+    }
+    return triangles;
+}
+
+/**
+ * @brief Faces of linked triangles whose vertices are in the array starting at base
+ */
+static Faces toFaces(const QVector<Triangle> &triangles,const Vector2D *base) {
+    Faces faces(triangles.size());
+    for (int t=0; t<triangles.size(); t++) {
+        for (int i=0; i<3; i++) {
+            faces[t].v[i]=int(triangles[t].getVertexPtr(i)-base);
+            faces[t].n[i]=triangles[t].getNeighbor(i);
+        }
+    }
+    return faces;
+}
+
+/**
+ * @brief Check the neighbors found by Triangle::buildAdjacency against the neighbors of the faces
+ */
+static QStringList checkAdjacency(const QVector<Triangle> &triangles,const Faces &faces) {
+    QStringList errors;
+    for (int t=0; t<triangles.size() && errors.size()<5; t++) {
+        for (int i=0; i<3; i++) {
+            const int n=triangles[t].getNeighbor(i);
+            if (n!=faces[t].n[i]) {
+                errors << QString("triangle %1 has the neighbor %2 instead of %3").arg(t).arg(n).arg(faces[t].n[i]);
+            } else if (n>=0) {
+                const int slot=triangles[t].getNeighborSlot(i);
+                if (slot<0 || slot>2 || triangles[n].getNeighbor(slot)!=t || triangles[n].getNeighborSlot(slot)!=i) {
+                    errors << QString("triangles %1 and %2 are not linked back").arg(t).arg(n);
+                }
+            }
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief Flip random edges whose quadrilateral is convex, the triangulation stays valid but is no more Delaunay
+ * @return the number of flips
+ */
+static int scramble(QVector<Triangle> &triangles,int tries) {
+    int flips=0;
+    for (int k=0; k<tries && !triangles.isEmpty(); k++) {
+        const int t=int(gen()%triangles.size()),i=int(gen()%3);
+        const Triangle &tri=triangles[t];
+        const int n=tri.getNeighbor(i);
+        if (n<0) continue;
+        const Vector2D &p=*tri.getVertexPtr(i),&q=*tri.getVertexPtr((i+1)%3),&r=*tri.getVertexPtr((i+2)%3);
+        const Vector2D &d=*triangles[n].getVertexPtr(tri.getNeighborSlot(i));
+        if (Predicates::orient2d(p,q,d)<=0 || Predicates::orient2d(d,r,p)<=0) continue;
+        Triangle::flipEdge(triangles,t,i);
+        flips++;
+    }
+    return flips;
+}
+
+/**
+ * @brief Check the flags and the count set by Triangle::certify against the tests of the circumcircles
+ *
+ * Every triangle flagged non Delaunay must have a neighbor vertex in its circumcircle, the count must be
+ * the number of flagged triangles, and it must be 0 exactly when the triangulation is Delaunay: tested
+ * against all the vertices for small inputs, across each edge otherwise.
+ */
+static QStringList checkCertification(const QVector<Triangle> &triangles,int nonDelaunay,const QVector<Vector2D> &vertices) {
+    QStringList errors;
+    int flagged=0;
+    bool delaunay=true;
+    for (int t=0; t<triangles.size(); t++) {
+        const Triangle &tri=triangles[t];
+        const Vector2D &a=*tri.getVertexPtr(0),&b=*tri.getVertexPtr(1),&c=*tri.getVertexPtr(2);
+        bool local=true;
+        for (int i=0; i<3; i++) {
+            const int n=tri.getNeighbor(i);
+            if (n>=0 && Predicates::incircle(a,b,c,*triangles[n].getVertexPtr(tri.getNeighborSlot(i)))>0) local=false;
+        }
+        if (tri.isDelaunayTriangle()!=local && errors.size()<5) {
+            errors << QString("triangle %1 is certified %2").arg(t).arg(local ? "non Delaunay" : "Delaunay");
+        }
+        if (!tri.isDelaunayTriangle()) flagged++;
+        if (vertices.size()<=2000) {
+            for (int v=0; v<vertices.size() && delaunay; v++) {
+                if (Predicates::incircle(a,b,c,vertices[v])>0) delaunay=false;
+            }
+        } else {
+            delaunay=delaunay && local;
+        }
+    }
+    if (flagged!=nonDelaunay) errors << QString("count of %1 non Delaunay triangles instead of %2").arg(nonDelaunay).arg(flagged);
+    if ((nonDelaunay==0)!=delaunay) errors << QString("count of %1 non Delaunay triangles for a triangulation %2Delaunay").arg(nonDelaunay).arg(delaunay ? "" : "non ");
+    return errors;
+}
+
+//-------------------------------------
+// checks
+
+/**
+ * @brief Inputs of the checks of the triangulations: name and points
+ */
+static QVector<QPair<QString,QVector<Vector2D>>> meshInputs() {
+    QVector<QPair<QString,QVector<Vector2D>>> inputs;
+    for (int n:{3,4,10,100,1000,100000}) inputs.append({QString("random %1").arg(n),randomPoints(n,1000)});
+    inputs.append({"flat triangle",{Vector2D(0,0),Vector2D(1000,1),Vector2D(1999,2)}});
+    QVector<Vector2D> line;
+    for (int i=0; i<100; i++) line.append(Vector2D(i,2*i));
+    inputs.append({"collinear",line});
+    inputs.append({"grid",gridPoints(100,10)});
+    inputs.append({"circle",circlePoints(360,400)});
+    QVector<Vector2D> duplicates=randomPoints(1000,1000);
+    duplicates+=duplicates.mid(0,300);
+    inputs.append({"duplicates",duplicates});
+    for (int i=0; i<2000; i++) inputs.append({QString("thin strip %1").arg(i),integerPoints(3+i%30,2000,3)});
+    for (int i=0; i<2000; i++) inputs.append({QString("small grid %1").arg(i),integerPoints(3+i%40,5,5)});
+    return inputs;
+}
+
+static int report(QTextStream &out,const QString &name,const QStringList &errors) {
+    if (errors.isEmpty()) {
+        out << "# check " << name << ": ok" << Qt::endl;
+        return 0;
+    }
+    out << "# check " << name << ": FAILED " << errors.mid(0,3).join("; ") << Qt::endl;
+    return 1;
+}
+
+/**
+ * @brief Run a check on all the inputs, stop at the first failed input
+ */
+static QStringList forEachInput(const std::function<QStringList(const QVector<Vector2D>&)> &check) {
+    static const QVector<QPair<QString,QVector<Vector2D>>> inputs=meshInputs();
+    for (const auto &input:inputs) {
+        QStringList errors=check(input.second);
+        if (!errors.isEmpty()) {
+            errors[0]=input.first+": "+errors[0];
+            return errors;
+        }
+    }
+    return {};
+}
+
+int SelfCheck::run(QTextStream &out) {
+    int failures=0;
+    failures+=report(out,"delaunay_build",forEachInput([](const QVector<Vector2D> &points) {
+        DelaunayTriangulation mesh;
+        mesh.build(points);
+        return checkMesh(mesh.getVertices(),mesh.getFaces(),mesh.getDuplicateCount());
+    }));
+    failures+=report(out,"triangle_adjacency",forEachInput([](const QVector<Vector2D> &points) {
+        DelaunayTriangulation mesh;
+        mesh.build(points);
+        QVector<Triangle> triangles=toTriangles(mesh);
+        Triangle::buildAdjacency(triangles);
+        return checkAdjacency(triangles,mesh.getFaces());
+    }));
+    failures+=report(out,"triangle_legalize",forEachInput([](const QVector<Vector2D> &points) {
+        DelaunayTriangulation mesh;
+        mesh.build(points);
+        QVector<Triangle> triangles=toTriangles(mesh);
+        Triangle::buildAdjacency(triangles);
+        scramble(triangles,triangles.size());
+        const Triangle::FlipReport flips=Triangle::legalize(triangles);
+        QStringList errors=checkMesh(mesh.getVertices(),toFaces(triangles,mesh.getVertices().constData()),mesh.getDuplicateCount());
+        if (!flips.delaunay) errors << QString("%1 non convex edges skipped").arg(flips.skipped);
+        return errors;
+    }));
+    failures+=report(out,"triangle_certify",forEachInput([](const QVector<Vector2D> &points) {
+        DelaunayTriangulation mesh;
+        mesh.build(points);
+        QVector<Triangle> triangles=toTriangles(mesh);
+        Triangle::buildAdjacency(triangles);
+        Triangle::resetCertification(triangles);
+        QStringList errors=checkCertification(triangles,Triangle::certify(triangles),mesh.getVertices());
+        if (errors.isEmpty()) {
+            scramble(triangles,triangles.size()/4+1);
+            errors=checkCertification(triangles,Triangle::certify(triangles),mesh.getVertices());
+        }
+        if (errors.isEmpty()) {
+            Triangle::legalize(triangles);
+            errors=checkCertification(triangles,Triangle::certify(triangles),mesh.getVertices());
+        }
+        return errors;
+    }));
+    // the number of blocks depends on the number of threads, not on the cores of the machine
+    WorkerPool pool(1);
+    for (int threads:{1,2,3,4,8}) {
+        pool.setThreadCount(threads);
+        failures+=report(out,QString("delaunay_divide_conquer %1 threads").arg(threads),forEachInput([&](const QVector<Vector2D> &points) {
+            DelaunayTriangulation mesh,reference;
+            mesh.buildDivideAndConquer(points,pool);
+            reference.build(points);
+            QStringList errors=checkMesh(mesh.getVertices(),mesh.getFaces(),mesh.getDuplicateCount());
+            if (mesh.getFaces().size()!=reference.getFaces().size() || mesh.getDuplicateCount()!=reference.getDuplicateCount()) {
+                errors << QString("%1 faces and %2 duplicates instead of %3 and %4 with build()")
+                          .arg(mesh.getFaces().size()).arg(mesh.getDuplicateCount())
+                          .arg(reference.getFaces().size()).arg(reference.getDuplicateCount());
+            }
+            return errors;
+        }));
+    }
+    // the kernels compute in float, the scalar code in double: positions up to 2000 keep 1e-4 of rounding
+    for (DroneKernel::Isa isa:{DroneKernel::sse4,DroneKernel::avx2}) {
+        const QString name=QString("flight_kernel %1").arg(DroneKernel::name(isa));
+        if (!DroneKernel::get(isa)) {
+            out << "# check " << name << ": skipped, not supported by the processor" << Qt::endl;
+            continue;
+        }
+        const DroneFleet::KernelAccuracy acc=DroneFleet::checkKernelAccuracy(isa);
+        QStringList errors;
+        if (!(acc.position<=1e-3)) errors << QString("position error %1").arg(acc.position);
+        if (!(acc.speed<=1e-3)) errors << QString("speed error %1").arg(acc.speed);
+        if (!(acc.azimut<=0.05)) errors << QString("azimut error %1 degree").arg(acc.azimut);
+        if (acc.statusMismatches>0) errors << QString("%1 status mismatches").arg(acc.statusMismatches);
+        failures+=report(out,name,errors);
+    }
+    out << "# checks failed: " << failures << Qt::endl;
+    return failures;
+}
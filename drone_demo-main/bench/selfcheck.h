@@ -0,0 +1,26 @@
+/**
+ * @file selfcheck.h
+ * @brief Correctness checks of the geometry code, run by drones_bench --check.
+ */
+#ifndef SELFCHECK_H
+#define SELFCHECK_H
+
+#include <QTextStream>
+
+/**
+ * @brief Checks of the triangulations on random and degenerate inputs, and of the flight kernels
+ *
+ * A flight kernel is checked against the scalar code for each instruction set supported by the processor.
+ * Each check prints one line "# check <name>: ok" or "# check <name>: FAILED <first errors>".
+ * The inputs are generated from a fixed seed, so a failure is reproducible.
+ */
+namespace SelfCheck {
+    /**
+     * @brief Run all the checks
+     * @param out stream receiving the results
+     * @return the number of failed checks
+     */
+    int run(QTextStream &out);
+}
+
+#endif // SELFCHECK_H
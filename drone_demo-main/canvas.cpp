@@ -6,8 +6,11 @@
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QDebug>
-#include <iostream>
+#include <cmath>
 #include "voronoi.h"
+#include "profiler.h"
+#include "logging.h"
+#include "workerpool.h"
 
 /**
  * @brief Constructs a new Canvas object.
@@ -25,6 +28,7 @@ Canvas::Canvas(QWidget *parent)
     voronoi(nullptr)
 {
     droneImg.load("../../media/drone.png");
+    droneSprites.build(droneImg, droneIconSize);
     setMouseTracking(true);
     showTriangles = true; // Ensure triangles are shown by default
     showDelaunay = false; // Delaunay is optional
@@ -57,6 +61,8 @@ void Canvas::clear()
 
     // Clear servers
     servers.clear();
+    serverLabels.clear();
+    serverByName.clear();
 
     // Clear drones if mapDrones
     if (mapDrones) {
@@ -65,6 +71,7 @@ void Canvas::clear()
         }
         mapDrones->clear();
     }
+    staticLayerDirty = sceneIndexDirty = true;
 }
 
 void Canvas::initializeVoronoi(const Vector2D& center) {
@@ -72,7 +79,7 @@ void Canvas::initializeVoronoi(const Vector2D& center) {
         voronoi = new Voronoi(center);  // Create a new Voronoi instance
     }
     voronoi->generate(Triangle::triangles);  // Generate edges based on triangles
-    update();  // Trigger repaint
+    invalidateStaticLayer();  // Trigger repaint
 }
 
 void Canvas::addPoints(const QVector<Vector2D> &tab)
@@ -80,55 +87,69 @@ void Canvas::addPoints(const QVector<Vector2D> &tab)
     // Just store them in vertices if you want
     for (const auto &pt : tab) {
         vertices.push_back(pt);
-        qDebug() << "Added vertex:" << pt.x << pt.y;
+        qCDebug(lcMesh) << "Added vertex:" << pt.x << pt.y;
     }
-    std::cout << "Total vertices after addition: " << vertices.size() << std::endl;
+    qCDebug(lcMesh) << "Total vertices after addition:" << vertices.size();
 
     reScale();
-    update();
+    invalidateStaticLayer();
 }
 
 
 bool Canvas::checkDelaunay()
 {
-    // Ensure tabVertices is populated
+    // Delaunay is a local property: only the triangles changed since the last check are tested
+    const int nonDelaunay = Triangle::certify(Triangle::triangles);
+    const bool areAllDelaunay = nonDelaunay == 0;
+    qCDebug(lcMesh) << "Delaunay certification:" << nonDelaunay << "of" << Triangle::triangles.size()
+                    << "triangles not Delaunay";
+
+    if (fullValidation && validateDelaunay() != areAllDelaunay) {
+        qCWarning(lcMesh) << "The full validation disagrees with the local certification.";
+    }
+
+    invalidateStaticLayer(); // Trigger a repaint
+    return areAllDelaunay;
+}
+
+bool Canvas::validateDelaunay()
+{
+    // Ensure tabVertices is populated, each vertex once
     QVector<Vector2D> allVertices;
+    QHash<QPair<float, float>, bool> seen;
     for (const Triangle &tri : Triangle::triangles) {
         for (int i = 0; i < 3; i++) {
-            if (!allVertices.contains(*tri.getVertexPtr(i))) {
-                allVertices.append(*tri.getVertexPtr(i));
+            const Vector2D *v = tri.getVertexPtr(i);
+            const QPair<float, float> key(v->x, v->y);
+            if (!seen.contains(key)) {
+                seen.insert(key, true);
+                allVertices.append(*v);
             }
         }
     }
 
     bool areAllDelaunay = true;
-
+    int disagreements = 0;
+    int nonDelaunay = 0;
     for (Triangle &triangle : Triangle::triangles) {
-        qDebug() << "Checking triangle with vertices: (" << triangle.getVertexPtr(0)->x
-                 << "," << triangle.getVertexPtr(0)->y << "), ("
-                 << triangle.getVertexPtr(1)->x << "," << triangle.getVertexPtr(1)->y << "), ("
-                 << triangle.getVertexPtr(2)->x << "," << triangle.getVertexPtr(2)->y << ")";
-
-        // Pass the populated vertices to checkDelaunay
-        bool res = triangle.checkDelaunay(allVertices);
-
-        if (!res) {
-            auto oppositePoints = findOppositePointOfTriangle(triangle);
-            auto it = oppositePoints.begin();
-            while (it != oppositePoints.end() && triangle.circleContains(*it)) {
-                ++it;
-            }
-
-            qDebug() << "Opposite points size:" << oppositePoints.size()
-                     << ", Iterator at end:" << (it != oppositePoints.end() ? "No" : "Yes");
-
-            triangle.setDelaunay(false, it != oppositePoints.end());
+        // Triangle::checkDelaunay() overwrites the flags set by the certification
+        const bool local = triangle.isDelaunayTriangle();
+        const bool flippable = triangle.isFlippable();
+        const bool res = triangle.checkDelaunay(allVertices);
+        if (res != local) {
+            disagreements++;
+            qCWarning(lcMesh) << "Triangle (" << triangle.getVertexPtr(0)->x << "," << triangle.getVertexPtr(0)->y << "), ("
+                              << triangle.getVertexPtr(1)->x << "," << triangle.getVertexPtr(1)->y << "), ("
+                              << triangle.getVertexPtr(2)->x << "," << triangle.getVertexPtr(2)->y << ")"
+                              << "is" << (res ? "" : "not") << "Delaunay but was certified the opposite";
         }
-
+        triangle.setDelaunay(res, !res && flippable);
         areAllDelaunay = res && areAllDelaunay;
+        if (!res) nonDelaunay++;
     }
-
-    update(); // Trigger a repaint
+    Triangle::nonDelaunayCount = nonDelaunay;
+    qCDebug(lcMesh) << "Full Delaunay validation:" << Triangle::triangles.size() << "triangles against"
+                    << allVertices.size() << "vertices," << disagreements << "disagreements";
     return areAllDelaunay;
 }
 
@@ -137,38 +158,9 @@ QVector<const Vector2D *> Canvas::findOppositePointOfTriangle(Triangle &tri)
 {
     QVector<const Vector2D *> list;
 
-    for (auto &otherTri : Triangle::triangles) {
-        // Skip self
-        if (&otherTri == &tri) continue;
-
-        // Find common edges
-        int commonCount = 0;
-        Vector2D *commonA = nullptr;
-        Vector2D *commonB = nullptr;
-
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                if (*tri.getVertexPtr(i) == *otherTri.getVertexPtr(j)) {
-                    if (commonCount == 0)
-                        commonA = tri.getVertexPtr(i);
-                    else if (commonCount == 1)
-                        commonB = tri.getVertexPtr(i);
-
-                    commonCount++;
-                }
-            }
-        }
-
-        // If exactly 2 vertices are shared, it's a common edge
-        if (commonCount == 2) {
-            for (int i = 0; i < 3; i++) {
-                const Vector2D *v = otherTri.getVertexPtr(i);
-                if (v != commonA && v != commonB) {
-                    list.append(v);
-                    break;
-                }
-            }
-        }
+    for (int i = 0; i < 3; i++) {
+        const int n = tri.getNeighbor(i);
+        if (n >= 0) list.append(Triangle::triangles[n].getVertexPtr(tri.getNeighborSlot(i)));
     }
 
     return list;
@@ -338,21 +330,82 @@ int triangleCount = 0;
 */
 
 
-void Canvas::paintEvent(QPaintEvent *) {
-    QPainter painter(this);
-
-    // 1) Fill background
-    painter.fillRect(rect(), Qt::white);
-
-    // 2) Apply transformations
+void Canvas::applyTransform(QPainter &painter) const {
     painter.translate(10, 10);
     painter.scale(scaleFactor, scaleFactor);
     painter.translate(-origin.x, -origin.y);
-    qDebug() << "paintEvent triggered. Drawing Voronoi cells...";
+}
+
+QRectF Canvas::visibleRect() const {
+    return QRectF(origin.x - 10 / scaleFactor, origin.y - 10 / scaleFactor, width() / scaleFactor, height() / scaleFactor);
+}
+
+void Canvas::buildSceneIndex() {
+    QVector<QRectF> boxes;
+    boxes.reserve(Triangle::triangles.size());
+    for (const Triangle &tri : Triangle::triangles) {
+        const Vector2D *a = tri.getVertexPtr(0), *b = tri.getVertexPtr(1), *c = tri.getVertexPtr(2);
+        const double left = qMin(a->x, qMin(b->x, c->x)), top = qMin(a->y, qMin(b->y, c->y));
+        boxes.append(QRectF(left, top, qMax(a->x, qMax(b->x, c->x)) - left, qMax(a->y, qMax(b->y, c->y)) - top));
+    }
+    triangleIndex.build(boxes);
+
+    boxes.clear();
+    for (const QLineF &edge : voronoiEdges) {
+        boxes.append(QRectF(edge.p1(), edge.p2()).normalized());
+    }
+    edgeIndex.build(boxes);
+
+    // a server is drawn with its name on its top right
+    boxes.clear();
+    for (int i = 0; i < servers.size(); i++) {
+        const Vector2D &pos = servers[i]->getPosition();
+        const QSizeF labelSize = i < serverLabels.size() ? serverLabels[i].size() : QSizeF();
+        boxes.append(QRectF(pos.x - 8, pos.y - 10 - labelSize.height(), 18 + labelSize.width(), 18 + labelSize.height()));
+    }
+    serverIndex.build(boxes);
+    sceneIndexDirty = false;
+}
+
+void Canvas::setServers(const QVector<Server *> &serverList) {
+    servers = serverList;
+    serverLabels.clear();
+    serverLabels.reserve(servers.size());
+    serverByName.clear();
+    serverByName.reserve(servers.size());
+    for (int i = 0; i < servers.size(); i++) {
+        QStaticText label(servers[i]->getName());
+        label.setPerformanceHint(QStaticText::AggressiveCaching);
+        serverLabels.append(label);
+        serverByName.insert(servers[i]->getName(), i);
+    }
+    invalidateStaticLayer();
+}
+
+void Canvas::renderStaticLayer() {
+    const qreal dpr = devicePixelRatioF();
+    staticLayer = QPixmap(size() * dpr);
+    staticLayer.setDevicePixelRatio(dpr);
+    staticLayer.fill(Qt::white);
+    staticLayerDirty = false;
+
+    QPainter painter(&staticLayer);
+    applyTransform(painter);
+    qCDebug(lcPaint) << "Static layer redrawn: triangles, Voronoi cells and servers";
+
+    // only the items in the widget are submitted, with a margin for the width of the pens
+    if (sceneIndexDirty) buildSceneIndex();
+    const double margin = 5 / scaleFactor;
+    const QRectF view = visibleRect().adjusted(-margin, -margin, margin, margin);
+
+    // each layer is timed separately
+    QElapsedTimer layerTimer;
+    layerTimer.start();
 
     // Draw the polygon
-    for (const Triangle &triangle : Triangle::triangles) {
-        triangle.draw(painter);  // Call the draw method for each triangle
+    triangleIndex.query(view, visibleItems);
+    for (int i : std::as_const(visibleItems)) {
+        Triangle::triangles[i].draw(painter);  // Call the draw method for each triangle
 
     }
     // Draw centers if toggled
@@ -372,73 +425,277 @@ void Canvas::paintEvent(QPaintEvent *) {
             if (tri.isHighlighted()) tri.drawCircle(painter);
         }
     }
+    Profiler::record(Profiler::paintTriangles, layerTimer.nsecsElapsed());
+    layerTimer.restart();
 
     // Draw Voronoi edges
     painter.setPen(QPen(Qt::blue, 2));
-    for (const QLineF& edge : voronoiEdges) {
-        painter.drawLine(edge);
+    edgeIndex.query(view, visibleItems);
+    for (int i : std::as_const(visibleItems)) {
+        painter.drawLine(voronoiEdges[i]);
     }
+    Profiler::record(Profiler::paintVoronoi, layerTimer.nsecsElapsed());
+    layerTimer.restart();
+
     QPen serverPen(Qt::blue);
     serverPen.setWidth(5);
     painter.setPen(serverPen);
 
-    for (const Server *server : servers) {
+    serverIndex.query(view, visibleItems);
+    for (int i : std::as_const(visibleItems)) {
+        const Server *server = servers[i];
         painter.drawEllipse(QPointF(server->getPosition().x, server->getPosition().y), 5, 5);
         painter.setPen(Qt::black);
-        painter.drawText(QPointF(server->getPosition().x + 10, server->getPosition().y - 10), server->getName());
+        // drawStaticText places the top left corner of the text, drawText the baseline
+        const QSizeF labelSize = serverLabels[i].size();
+        painter.drawStaticText(QPointF(server->getPosition().x + 10, server->getPosition().y - 10 - labelSize.height() * 0.8), serverLabels[i]);
         painter.setPen(serverPen);
-        qDebug() << "Server added:" << server->getName()
-                 << "Position: (" << server->getPosition().x << "," << server->getPosition().y << ")";
     }
+    Profiler::record(Profiler::paintServers, layerTimer.nsecsElapsed());
+}
 
-    if (mapDrones) {
-        QPen penCol(Qt::DashDotDotLine);
-        penCol.setColor(Qt::lightGray);
-        penCol.setWidth(3);
+void Canvas::paintEvent(QPaintEvent *) {
+    ScopedTimer paintTimer(Profiler::paint);
 
-        QRect rectIcon(-droneIconSize / 2,
-                       -droneIconSize / 2,
-                       droneIconSize,
-                       droneIconSize);
+    // 1) Static geometry, redrawn only when it changed
+    if (staticLayerDirty || staticLayer.size() != size() * devicePixelRatioF()) {
+        renderStaticLayer();
+    }
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, staticLayer);
 
-        QRect rectCol(-droneCollisionDistance / 2,
-                      -droneCollisionDistance / 2,
-                      droneCollisionDistance,
-                      droneCollisionDistance);
+    // 2) Apply transformations
+    applyTransform(painter);
+
+    // the drones are composited on the static layer
+    QElapsedTimer layerTimer;
+    layerTimer.start();
+
+    // the drones are collected then drawn in one batch, with a level of detail depending on the zoom
+    const DroneLod lod = getDroneLod();
+    droneFragments.clear();
+    dronePoints.clear();
+    collisionCenters.clear();
+    droneClusters.clear();
+    dronePads.clear();
+    // regions of the clusters: a power of two of grid cells, wide enough on screen for a glyph
+    double regionSize = fleet ? fleet->getGrid().getCellSize() : droneCollisionDistance;
+    while (regionSize * scaleFactor < clusterPixels) regionSize *= 2;
+
+    // only the drones in the widget, or whose collision circle is in the widget, are drawn
+    const QRectF droneView = visibleRect().adjusted(-droneCollisionDistance, -droneCollisionDistance, droneCollisionDistance, droneCollisionDistance);
+    const bool culled = lod != lodClusters; // the clusters count all the drones of their region
+
+    if (replay && replay->isOpen()) {
+        // Replay mode: the drones of the restored step
+        for (int i = 0; i < replay->getDroneCount(); i++) {
+            Vector2D p = replay->getPosition(i);
+            const QPointF dronePos(p.x, p.y);
+            if (!culled || droneView.contains(dronePos)) collectDrone(lod, dronePos, replay->getAzimut(i), replay->hasCollision(i), regionSize);
+        }
+    } else if (lod == lodClusters && fleet) {
+        // Drones out of the ground: counted from the cells of the collision grid, maintained by the fleet,
+        // without visiting the drones
+        const SpatialGrid &grid = fleet->getGrid();
+        const double cellSize = grid.getCellSize();
+        for (auto it = grid.getCells().constBegin(); it != grid.getCells().constEnd(); ++it) {
+            const QPointF cellCenter((SpatialGrid::keyX(it.key()) + 0.5) * cellSize, (SpatialGrid::keyY(it.key()) + 0.5) * cellSize);
+            addToCluster(cellCenter, it.value().size(), regionSize);
+        }
+        // Landed drones: on their server, counted by the server on take off and landing
+        for (Server *server : servers) {
+            const int landedCount = server->getLandedCount();
+            if (landedCount > 0) addToCluster(QPointF(server->getPosition().x, server->getPosition().y), landedCount, regionSize);
+        }
+    } else if (fleet) {
+        // Drones out of the ground: from the cells of the collision grid around the view, a drone moving
+        // less than a cell between the grid update and the drawn position
+        const SpatialGrid &grid = fleet->getGrid();
+        const double cellSize = grid.getCellSize();
+        const int cx0 = int(std::floor((droneView.left() - cellSize) / cellSize)), cx1 = int(std::floor((droneView.right() + cellSize) / cellSize));
+        const int cy0 = int(std::floor((droneView.top() - cellSize) / cellSize)), cy1 = int(std::floor((droneView.bottom() + cellSize) / cellSize));
+        auto collectCell = [&](const QVector<int> &cell) {
+            for (int i : cell) {
+                if (fleet->getStatus(i) == DroneModel::landed) continue; // landed during the last step, drawn on its server
+                Vector2D p = fleet->getInterpolatedPosition(i, interpolation);
+                const QPointF dronePos(p.x, p.y);
+                if (droneView.contains(dronePos)) collectDrone(lod, dronePos, fleet->getAzimut(i), fleet->hasCollision(i), regionSize);
+            }
+        };
+        if (qint64(cx1 - cx0 + 1) * (cy1 - cy0 + 1) <= grid.getCells().size()) {
+            for (int cy = cy0; cy <= cy1; cy++) {
+                for (int cx = cx0; cx <= cx1; cx++) {
+                    const QVector<int> *cell = grid.cell(SpatialGrid::makeKey(cx, cy));
+                    if (cell) collectCell(*cell);
+                }
+            }
+        } else {
+            // more cells in the view than non-empty cells
+            for (auto it = grid.getCells().constBegin(); it != grid.getCells().constEnd(); ++it) {
+                const int cx = SpatialGrid::keyX(it.key()), cy = SpatialGrid::keyY(it.key());
+                if (cx >= cx0 && cx <= cx1 && cy >= cy0 && cy <= cy1) collectCell(it.value());
+            }
+        }
 
+        // Drones on the ground, or starting and not yet in the grid: from the servers in the view,
+        // the landed drones of a server as one drone on its pad with their number
+        if (sceneIndexDirty) buildSceneIndex();
+        serverIndex.query(droneView, visibleItems);
+        for (int s : std::as_const(visibleItems)) {
+            const Server *server = servers[s];
+            const QPointF serverPos(static_cast<int>(server->getPosition().x), static_cast<int>(server->getPosition().y));
+            if (server->getLandedCount() > 0) {
+                collectDrone(lod, serverPos, 0, false, regionSize);
+                if (server->getLandedCount() > 1) dronePads.append(qMakePair(serverPos, server->getLandedCount()));
+            }
+            for (Drone *drone : server->getLaunchingDrones()) {
+                if (drone->getStatus() != Drone::takeoff || grid.contains(drone->getIndex())) continue;
+                Vector2D p = drone->getInterpolatedPosition(interpolation);
+                collectDrone(lod, QPointF(p.x, p.y), drone->getAzimut(), drone->hasCollision(), regionSize);
+            }
+        }
+    } else if (mapDrones) {
         for (auto &drone : *mapDrones) {
-            QPoint serverPos(-1, -1); // Default to an invalid position
-            for (Server* server : servers) { // Assuming 'servers' is accessible here
-                if (server->getName() == drone->getServerName()) {
-                    // Manually convert from Vector2D to QPoint
-                    serverPos = QPoint(static_cast<int>(server->getPosition().x), static_cast<int>(server->getPosition().y));
-                    break; // Break once the matching server is found
+            QPointF dronePos;
+            if (drone->getStatus() != Drone::landed) {
+                // Flying drones are drawn between their two last simulated positions
+                Vector2D p = drone->getInterpolatedPosition(interpolation);
+                dronePos = QPointF(p.x, p.y);
+            } else {
+                const Server *server = drone->getServer();
+                if (!server) {
+                    qCWarning(lcPaint) << "No valid server found for drone:" << drone->getName();
+                    continue; // Skip drawing this drone if no server is found
                 }
+                const QPoint serverPos(static_cast<int>(server->getPosition().x), static_cast<int>(server->getPosition().y));
+                dronePos = serverPos;
             }
 
-            if (serverPos.x() == -1 && serverPos.y() == -1) {
-                qDebug() << "No valid server found for drone:" << drone->getName();
-                continue; // Skip drawing this drone if no server is found
-            }
+            if (!culled || droneView.contains(dronePos)) collectDrone(lod, dronePos, drone->getAzimut(), drone->hasCollision(), regionSize);
+        }
+    }
 
-            painter.save();
-            painter.translate(serverPos.x(), serverPos.y());
-            painter.rotate(drone->getAzimut());
-            painter.drawImage(rectIcon, droneImg);
+    if (lod == lodIcons) {
+        droneSprites.draw(painter, droneFragments);
 
-            // Draw collision circle if needed
-            if (drone->hasCollision()) {
-                painter.setPen(penCol);
-                painter.setBrush(Qt::NoBrush);
-                painter.drawEllipse(rectCol);
+        if (!collisionCenters.isEmpty()) {
+            QPen penCol(Qt::DashDotDotLine);
+            penCol.setColor(Qt::lightGray);
+            penCol.setWidth(3);
+            painter.setPen(penCol);
+            painter.setBrush(Qt::NoBrush);
+            for (const QPointF &center : collisionCenters) {
+                painter.drawEllipse(center, droneCollisionDistance / 2, droneCollisionDistance / 2);
             }
-
-            painter.restore();
         }
+    } else if (lod == lodPoints) {
+        // a point of the size of the icon on screen, red when a collision is detected
+        QPen penPoint(Qt::darkBlue);
+        penPoint.setCosmetic(true);
+        penPoint.setWidthF(qMax(3.0, droneIconSize * scaleFactor * 0.5));
+        penPoint.setCapStyle(Qt::RoundCap);
+        painter.setPen(penPoint);
+        painter.drawPoints(dronePoints.constData(), dronePoints.size());
+        penPoint.setColor(Qt::red);
+        painter.setPen(penPoint);
+        painter.drawPoints(collisionCenters.constData(), collisionCenters.size());
+    } else {
+        drawClusters(painter);
+    }
+    drawPads(painter);
+    Profiler::record(Profiler::paintDrones, layerTimer.nsecsElapsed());
+
+    // Timing overlay, in screen coordinates
+    if (showProfiler) {
+        painter.resetTransform();
+        QFont font("Monospace", 8);
+        font.setStyleHint(QFont::TypeWriter);
+        painter.setFont(font);
+        const QString text = Profiler::summary();
+        QRect textRect = painter.boundingRect(QRect(0, 0, width(), height()), Qt::AlignLeft | Qt::AlignTop, text);
+        textRect.moveTopLeft(QPoint(10, 10));
+        painter.fillRect(textRect.adjusted(-5, -5, 5, 5), QColor(255, 255, 255, 220));
+        painter.setPen(Qt::black);
+        painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, text);
+    }
+}
+
+Canvas::DroneLod Canvas::getDroneLod() const {
+    const double iconPixels = droneIconSize * scaleFactor;
+    if (iconPixels >= lodIconPixels) return lodIcons;
+    return iconPixels >= lodPointPixels ? lodPoints : lodClusters;
+}
 
+void Canvas::addToCluster(const QPointF &p, int count, double regionSize) {
+    DroneCluster &cluster = droneClusters[SpatialGrid::makeKey(int(std::floor(p.x() / regionSize)), int(std::floor(p.y() / regionSize)))];
+    cluster.x += p.x() * count;
+    cluster.y += p.y() * count;
+    cluster.count += count;
+}
+
+void Canvas::collectDrone(DroneLod lod, const QPointF &pos, double azimut, bool collision, double regionSize) {
+    if (lod == lodClusters) {
+        addToCluster(pos, 1, regionSize);
+    } else if (lod == lodPoints) {
+        (collision ? collisionCenters : dronePoints).append(pos);
+    } else {
+        droneFragments.append(droneSprites.fragment(pos, azimut));
+
+        // Draw collision circle if needed
+        if (collision) collisionCenters.append(pos);
     }
 }
 
+void Canvas::drawClusters(QPainter &painter) {
+    // the glyphs keep their size on screen: drawn without the transformation
+    const QTransform transform = painter.transform();
+    painter.save();
+    painter.resetTransform();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QPen(Qt::darkBlue, 2));
+    painter.setBrush(QColor(255, 165, 0, 200));
+    for (const DroneCluster &cluster : std::as_const(droneClusters)) {
+        const QPointF center = transform.map(QPointF(cluster.x / cluster.count, cluster.y / cluster.count));
+        const double radius = 10 + 3 * std::log2(double(cluster.count));
+        if (center.x() < -radius || center.y() < -radius || center.x() > width() + radius || center.y() > height() + radius) continue;
+        const QRectF rect(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius);
+        painter.drawEllipse(rect);
+        painter.drawText(rect, Qt::AlignCenter, QString::number(cluster.count));
+    }
+    painter.restore();
+}
+
+void Canvas::drawPads(QPainter &painter) {
+    if (dronePads.isEmpty()) return;
+    // the numbers keep their size on screen, at the top right of the drone drawn on the pad
+    const QTransform transform = painter.transform();
+    const double offset = qMax(3.0, droneIconSize * scaleFactor * 0.5);
+    painter.save();
+    painter.resetTransform();
+    painter.setPen(Qt::darkBlue);
+    for (const QPair<QPointF, int> &pad : std::as_const(dronePads)) {
+        const QPointF corner = transform.map(pad.first) + QPointF(offset, -offset);
+        painter.drawText(corner, QString::number(pad.second));
+    }
+    painter.restore();
+}
+
+void Canvas::wheelEvent(QWheelEvent *event)
+{
+    // the point of the canvas under the mouse stays in place
+    const QPointF pos = event->position();
+    const Vector2D p((pos.x() - 10) / scaleFactor + origin.x, (pos.y() - 10) / scaleFactor + origin.y);
+    scaleFactor = qBound(0.01f, float(scaleFactor * std::pow(1.0015, event->angleDelta().y())), 20.0f);
+    origin = Vector2D(p.x - (pos.x() - 10) / scaleFactor, p.y - (pos.y() - 10) / scaleFactor);
+    invalidateView();
+    event->accept();
+}
+
+void Canvas::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::RightButton) panning = false;
+}
+
 void Canvas::resizeEvent(QResizeEvent *)
 {
     reScale();
@@ -486,37 +743,50 @@ void Canvas::reScale()
 void Canvas::mousePressEvent(QMouseEvent *event)
 {
     if (!event) return;
+    if (event->button() == Qt::RightButton) {
+        // dragging with the right button moves the view
+        panning = true;
+        panStart = event->pos();
+        return;
+    }
 
     float canvasX = (event->pos().x() - 10) / scaleFactor + origin.x;
     float canvasY = (event->pos().y() - 10) / scaleFactor + origin.y;
     Vector2D clickPosition(canvasX, canvasY);
 
-    qDebug() << "Mouse clicked at screen coordinates:" << event->pos().x() << event->pos().y();
-    qDebug() << "Transformed to canvas coordinates:" << canvasX << canvasY;
+    qCDebug(lcInput) << "Mouse clicked at screen coordinates:" << event->pos().x() << event->pos().y();
+    qCDebug(lcInput) << "Transformed to canvas coordinates:" << canvasX << canvasY;
 
     // Check if the click is inside any triangle
     for (Triangle &tri : Triangle::triangles) {
-        qDebug() << "Checking triangle with vertices: ("
+        qCDebug(lcInput) << "Checking triangle with vertices: ("
                  << tri.getVertexPtr(0)->x << "," << tri.getVertexPtr(0)->y << "), ("
                  << tri.getVertexPtr(1)->x << "," << tri.getVertexPtr(1)->y << "), ("
                  << tri.getVertexPtr(2)->x << "," << tri.getVertexPtr(2)->y << ")";
         if (tri.isInside(clickPosition)) {
-            qDebug() << "Point is inside the triangle!";
+            qCDebug(lcInput) << "Point is inside the triangle!";
             tri.setHighlighted(tri.isInside(canvasX, canvasY));
               //tri.flippIt(); // Attempt to flip the clicked triangle
-            update(); // Repaint after the change
+            invalidateStaticLayer(); // Repaint after the change
             return;
         } else {
-            qDebug() << "Point is outside the triangle.";
+            qCDebug(lcInput) << "Point is outside the triangle.";
         }
     }
 
-    qDebug() << "No triangle clicked.";
+    qCDebug(lcInput) << "No triangle clicked.";
 
-    update();
+    invalidateStaticLayer();
 }
 
 void Canvas::mouseMoveEvent(QMouseEvent *event) {
+    if (panning) {
+        const QPoint delta = event->pos() - panStart;
+        panStart = event->pos();
+        origin = Vector2D(origin.x - delta.x() / scaleFactor, origin.y - delta.y() / scaleFactor);
+        invalidateView();
+        return;
+    }
     float mouseX = static_cast<float>(event->pos().x() - 10) / scale + origin.x;
     float mouseY = -static_cast<float>(event->pos().y() - height() + 10) / scale + origin.y;
     emit updateSB(QString("Mouse position= (") + QString::number(mouseX, 'f', 1) + "," + QString::number(mouseY, 'f', 1) + ")");
@@ -532,12 +802,12 @@ bool Canvas::handleTriangleClick(const Vector2D &clickPosition)
 {
     for (Triangle &tri :  Triangle::triangles) {
         if (tri.isInside(clickPosition)) {
-            qDebug() << "Triangle clicked!";
+            qCDebug(lcInput) << "Triangle clicked!";
                //tri.flippIt(); // Attempt to flip the clicked triangle
           //  return true; // Triangle was clicked
         }
     }
-    qDebug() << "No triangle clicked.";
+    qCDebug(lcInput) << "No triangle clicked.";
     return false; // No triangle was clicked
 }
 
@@ -547,87 +817,122 @@ void Canvas::handleDroneClick(const QPoint &screenPos)
 
 }
 Server* Canvas::findServerByName(const QString &name) {
-    for (Server* srv : servers) {
-        if (srv->getName() == name) {
-            return srv;
+    const int i = serverByName.value(name, -1);
+    return i < 0 ? nullptr : servers[i];
+}
+Server* Canvas::findNearestServer(const Vector2D &pos) {
+    if (servers.isEmpty() || !std::isfinite(pos.x) || !std::isfinite(pos.y)) return nullptr;
+    if (sceneIndexDirty) buildSceneIndex();
+    // a server closer than r has its box in the square of half side r around pos,
+    // the square of half side reach covers all the servers
+    const QRectF &bounds = serverIndex.getBounds();
+    const double reach = qMax(qMax(pos.x - bounds.left(), bounds.right() - pos.x), qMax(pos.y - bounds.top(), bounds.bottom() - pos.y));
+    QVector<int> items;
+    for (double r = 64;; r *= 2) {
+        serverIndex.query(QRectF(pos.x - r, pos.y - r, 2 * r, 2 * r), items);
+        Server *nearest = nullptr;
+        double nearestDist2 = 0;
+        for (int s : std::as_const(items)) {
+            const Vector2D d = servers[s]->getPosition() - pos;
+            const double dist2 = double(d.x) * d.x + double(d.y) * d.y;
+            if (!nearest || dist2 < nearestDist2) {
+                nearest = servers[s];
+                nearestDist2 = dist2;
+            }
         }
+        if (nearest && nearestDist2 <= r * r) return nearest;
+        if (!(r < reach)) return nearest; // also ends on non finite server positions
     }
-    return nullptr;
 }
-void Canvas::setPolygon(const MyPolygon& polygon) {
-    myPolygon = polygon;
-    update();  // Optionally, trigger a repaint whenever a new polygon is set
-}
-
-void Canvas::flippAll() {
-    bool anyFlipped = true;
-    int maxIterations = 1000; // Avoid infinite loops
-    int iteration = 0;
-
-    while (anyFlipped && iteration < maxIterations) {
-        anyFlipped = false;
-
-        for (auto& tri : Triangle::triangles) {
-            if (tri.isFlippable()) {
-                qDebug() << "Attempting to flip triangle: ("
-                         << tri.getVertexPtr(0)->x << "," << tri.getVertexPtr(0)->y << "), ("
-                         << tri.getVertexPtr(1)->x << "," << tri.getVertexPtr(1)->y << "), ("
-                         << tri.getVertexPtr(2)->x << "," << tri.getVertexPtr(2)->y << ")";
-
-                tri.flippIt(Triangle::triangles);
-                anyFlipped = true;
-                break; // Restart loop after a flip
+void Canvas::triangulate(const QVector<Vector2D> &points) {
+    // the divide and conquer does more work than build(): only its blocks are shared between the threads,
+    // the sort and the face extraction stay serial. It needs several threads to catch up, 4 keeps a margin
+    // for the memory bandwidth, and enough points for the blocks to outweigh the cost of the tasks.
+    if (workerPool && points.size() >= parallelTriangulationSize && workerPool->getThreadCount() >= parallelTriangulationThreads) {
+        mesh.buildDivideAndConquer(points, *workerPool);
+    } else {
+        mesh.build(points);
+    }
+    if (mesh.getDuplicateCount() > 0) {
+        qCWarning(lcMesh) << mesh.getDuplicateCount() << "duplicate points ignored by the triangulation";
+    }
+    const QVector<DelaunayTriangulation::Face> &faces = mesh.getFaces();
+    Triangle::triangles.clear();
+    Triangle::triangles.reserve(faces.size());
+    for (int fi = 0; fi < faces.size(); fi++) {
+        const DelaunayTriangulation::Face &f = faces[fi];
+        Triangle tri(mesh.getVertexPtr(f.v[0]), mesh.getVertexPtr(f.v[1]), mesh.getVertexPtr(f.v[2]), Qt::yellow);
+        // same order as the faces: the neighbors are the adjacent faces
+        for (int i = 0; i < 3; i++) {
+            int slot = -1;
+            if (f.n[i] >= 0) {
+                for (int j = 0; j < 3; j++) {
+                    if (faces[f.n[i]].n[j] == fi) slot = j;
+                }
             }
+            tri.setNeighbor(i, f.n[i], slot);
         }
-
-        iteration++;
-        if (!anyFlipped) {
-            qDebug() << "No more flippable triangles found.";
-        }
+        Triangle::triangles.append(tri);
     }
+    Triangle::resetCertification(Triangle::triangles);
+    qCDebug(lcMesh) << "Delaunay triangulation:" << points.size() << "points," << faces.size() << "triangles";
+    invalidateStaticLayer();
+}
 
-    if (iteration >= maxIterations) {
-        qDebug() << "Max iterations reached. Stopping flipping process.";
-    }
+void Canvas::setPolygon(const MyPolygon& polygon) {
+    myPolygon = polygon;
+    invalidateStaticLayer();  // Optionally, trigger a repaint whenever a new polygon is set
+}
 
-    checkDelaunay(); // Recheck Delaunay condition after all flips
+Triangle::FlipReport Canvas::flippAll() {
+    ScopedTimer timer(Profiler::triangulation);
+    const Triangle::FlipReport report = Triangle::legalize(Triangle::triangles);
+    qCDebug(lcMesh) << "Lawson flips:" << report.flipped << "flips," << report.tested << "edge tests,"
+                    << report.skipped << "non convex edges skipped";
+
+    // only the flipped triangles and their neighbors are certified again
+    checkDelaunay();
+    return report;
 }
 
 void Canvas::generateVoronoi() {
+    ScopedTimer timer(Profiler::voronoi);
     voronoiEdges.clear();  // Clear any previous Voronoi edges
 
-    // Iterate over all servers
-    for (Server* server : servers) {
-        Vector2D center = server->getPosition();
-        QVector<QLineF> localEdges;
-
-        // Iterate over triangles and find those containing the server position
-        for (const Triangle& triangle : Triangle::triangles) {
-            if (triangle.contains(center)) {
-                // Generate Voronoi edges for this server
-                for (int i = 0; i < 3; ++i) {
-                    const Vector2D* v1 = triangle.getVertexPtr(i);
-                    const Vector2D* v2 = triangle.getVertexPtr((i + 1) % 3);
-
-                    // Find a neighboring triangle sharing this edge
-                    for (const Triangle& neighbor : Triangle::triangles) {
-                        if (&triangle != &neighbor && neighbor.hasEdge(*v1, *v2)) {
-                            QLineF edge(triangle.getCircleCenter().x, triangle.getCircleCenter().y,
-                                        neighbor.getCircleCenter().x, neighbor.getCircleCenter().y);
-                            localEdges.append(edge);
-                            break;
-                        }
-                    }
-                }
+    // Server at each vertex of the triangulation
+    QHash<QPair<float, float>, int> serverAt;
+    serverAt.reserve(servers.size());
+    for (int s = 0; s < servers.size(); s++) {
+        const Vector2D center = servers[s]->getPosition();
+        serverAt.insert(qMakePair(float(center.x), float(center.y)), s);
+    }
+
+    // One pass over the triangles: each triangle adds the edges between its circumcenter
+    // and those of its neighbors to the cells of the servers at its vertices
+    QVector<QVector<QLineF>> localEdges(servers.size());
+    for (const Triangle& triangle : Triangle::triangles) {
+        for (int v = 0; v < 3; ++v) {
+            const Vector2D* vertex = triangle.getVertexPtr(v);
+            const int s = serverAt.value(qMakePair(float(vertex->x), float(vertex->y)), -1);
+            if (s < 0) continue;
+            for (int i = 0; i < 3; ++i) {
+                // neighbor across the edge (i, i+1)
+                const int n = triangle.getNeighbor((i + 2) % 3);
+                if (n < 0) continue;
+                const Triangle& neighbor = Triangle::triangles[n];
+                localEdges[s].append(QLineF(triangle.getCircleCenter().x, triangle.getCircleCenter().y,
+                                            neighbor.getCircleCenter().x, neighbor.getCircleCenter().y));
             }
         }
+    }
 
-        // Append local edges to global Voronoi edges
-        voronoiEdges.append(localEdges);
+    // Append local edges to global Voronoi edges, server by server
+    for (const QVector<QLineF>& edges : localEdges) {
+        voronoiEdges.append(edges);
     }
 
-    qDebug() << "Generated Voronoi edges. Total edges:" << voronoiEdges.size();
-    update();  // Trigger repaint to render Voronoi
+    qCDebug(lcMesh) << "Generated Voronoi edges. Total edges:" << voronoiEdges.size();
+    invalidateStaticLayer();  // Trigger repaint to render Voronoi
 }
 
 QVector<QLineF> Canvas::getVoronoiEdges() const {
@@ -5,12 +5,19 @@
 #include <QVector>
 #include <QMap>
 #include <QImage>
+#include <QPixmap>
+#include <QStaticText>
+#include <QHash>
 #include "vector2d.h"
 #include "triangle.h"
 #include "drone.h"
 #include "server.h"
 #include "mypolygon.h"
 #include "voronoi.h"
+#include "trajectoryreader.h"
+#include "spriteatlas.h"
+#include "viewportindex.h"
+#include "delaunaytriangulation.h"
 
 /**
  * @class Canvas
@@ -28,11 +35,25 @@ public:
     bool showCircles; ///< If true, circumcircles will be shown.
 
     bool showTriangles = true;///< If true, triangles will be shown by default.
+    bool showProfiler = false; ///< If true, the timings of the phases are drawn over the canvas.
+    bool fullValidation = false; ///< If true, checkDelaunay() also tests every triangle against every vertex (slow, for debugging).
 
 
     const int droneIconSize = 64; ///< size of the drone picture in the canvas
     const double droneCollisionDistance = droneIconSize * 1.5; ///< distance to detect collision with other drone
 
+    /**
+     * @brief Level of detail of the drones, chosen from the size of a drone icon on screen
+     */
+    enum DroneLod {
+        lodIcons,    ///< rotated icons and collision circles
+        lodPoints,   ///< a colored point per drone
+        lodClusters  ///< a glyph with the number of drones per region
+    };
+    const double lodIconPixels = 24; ///< smallest size of the drone icon on screen (pixels) drawn as an icon
+    const double lodPointPixels = 6; ///< smallest size of the drone icon on screen (pixels) drawn as a point
+    const double clusterPixels = 48; ///< smallest size of the regions of the clusters on screen (pixels)
+
     //QVector<Vector2D> triangleVertices; // Add this to store triangle points
     QVector<MyPolygon*> polygons;  /// to store ear-clipped polygons
 
@@ -56,8 +77,14 @@ public:
 
 
     void setMap(QMap<QString, Drone *> *map) { mapDrones = map; } ///< Sets the map of drones.
+    void setFleet(const DroneFleet *p_fleet) { fleet = p_fleet; } ///< Sets the fleet engine, whose collision grid gives the clusters of drones.
+    void setWorkerPool(WorkerPool *p_pool) { workerPool = p_pool; } ///< Sets the threads running the triangulation of large sets (nullptr for none).
+    DroneLod getDroneLod() const; ///< Gets the level of detail of the drones at the current zoom.
+    void setInterpolation(double alpha) { interpolation = alpha; } ///< Sets the fraction of simulation step used to draw the flying drones.
+    void setReplay(const TrajectoryReader *reader) { replay = reader; } ///< Draws the drones of a recorded step instead of the live ones (nullptr to go back to live).
     // void setServerPositions(const QVector<Vector2D> &positions) { serverPositions = positions; }
-    void setServers(const QVector<Server *> &serverList) { servers = serverList; }///< Sets the list of server objects.
+    void setServers(const QVector<Server *> &serverList);///< Sets the list of server objects.
+    void invalidateStaticLayer() { staticLayerDirty = sceneIndexDirty = true; update(); } ///< Re-indexes and redraws the triangles, Voronoi edges and servers at the next paint.
 
     inline int getSizeofV() { return vertices.size();}///< Returns the number of vertices.
     inline int getSizeofT() { return triangles.size();}///< Returns the number of triangles.
@@ -72,11 +99,13 @@ public:
     void addTriangle(int id0, int id1, int id2) ;
     void addTriangle(const Vector2D &v1, const Vector2D &v2, const Vector2D &v3, const QColor &color) ;
 
-    bool checkDelaunay();///< Checks if the current triangulation is Delaunay.
+    bool checkDelaunay();///< Certifies the triangles changed since the last check and returns whether the triangulation is Delaunay.
+    bool validateDelaunay();///< Tests every triangle against every vertex, O(T.V), and reports the disagreements with the local certification.
     void clearTriangles(); ///< Clears all triangles from the canvas.
-    void flippAll();///< Flips all flippable edges.
+    Triangle::FlipReport flippAll();///< Flips the non Delaunay edges until the triangulation is Delaunay.
 
     void setPolygon(const MyPolygon& polygon);///< Sets the current polygon to be drawn.
+    void triangulate(const QVector<Vector2D> &points);///< Builds the Delaunay triangulation of the points in Triangle::triangles.
 
 
     void generateSimpleTriangles() ;///< Generates simple triangles.
@@ -87,6 +116,7 @@ public:
 
     //void loadMesh(const QString &filePath);
     Server* findServerByName(const QString& name) ;///< Finds a server by its name.
+    Server* findNearestServer(const Vector2D &pos);///< Finds the server nearest to a position, nullptr if there is none.
 
     void drawTrianglesWithOppositeVerticesCheck() ; ///< Draws triangles with checks for opposite vertices.
     QVector<Vector2D> computeCircumcenters(); ///< Compute circumcenters of all triangles
@@ -104,6 +134,8 @@ protected:
     void mouseMoveEvent(QMouseEvent *event) override; ///< Handles mouse move events.
     void mousePressEvent(QMouseEvent *event) override; ///< Handles mouse press events.
     void resizeEvent(QResizeEvent *event) override; ///< Handles resize events.
+    void wheelEvent(QWheelEvent *event) override; ///< Zooms around the mouse position.
+    void mouseReleaseEvent(QMouseEvent *event) override; ///< Ends the panning.
 
 private:
     QPair<Vector2D, Vector2D> getBox(); ///< Calculates the bounding box.
@@ -111,13 +143,53 @@ private:
     void generateTriangles();///< Generates the triangles.
     float scaleFactor = 1.0f; ///< The scale factor for drawing.
     MyPolygon myPolygon; ///< Polygon to be drawn.
+    static const int parallelTriangulationSize = 100000; ///< Smallest number of servers triangulated on several threads.
+    static const int parallelTriangulationThreads = 4; ///< Smallest number of threads of the pool for the parallel triangulation.
+    WorkerPool *workerPool = nullptr; ///< Threads shared with the fleet, running the triangulation of large sets.
+    DelaunayTriangulation mesh; ///< Delaunay triangulation of the servers, owns the vertices of Triangle::triangles.
 
     QVector<Triangle> triangles;///< List of triangles.
     QVector<Vector2D> vertices;///< List of vertices.
     QVector<Server *> servers;///< List of servers.
+    QHash<QString, int> serverByName; ///< Index in servers of each server name.
     QVector<Vector2D> serverPositions;///< Positions of servers.
     QMap<QString, Drone *> *mapDrones = nullptr;///< Map of drones.
     QImage droneImg;  ///< Image of the drone.
+    SpriteAtlas droneSprites; ///< Image of the drone pre-rotated at 64 angles.
+    QVector<QPainter::PixmapFragment> droneFragments; ///< Sprites of the drones of the current frame.
+    QVector<QPointF> collisionCenters; ///< Positions of the drones of the current frame which detect a collision.
+    QVector<QPointF> dronePoints; ///< Positions of the drones of the current frame without collision, at mid zoom.
+    /**
+     * @brief Drones gathered in a region of the canvas, at far zoom
+     */
+    struct DroneCluster {
+        double x = 0, y = 0; ///< sum of the positions, weighted by the counts
+        int count = 0;       ///< number of drones
+    };
+    QHash<quint64, DroneCluster> droneClusters; ///< Clusters of the current frame, keyed on their region.
+    void addToCluster(const QPointF &p, int count, double regionSize); ///< Adds count drones at p to the cluster of its region.
+    void collectDrone(DroneLod lod, const QPointF &pos, double azimut, bool collision, double regionSize); ///< Adds a drone to the batch of its level of detail.
+    void drawClusters(QPainter &painter); ///< Draws the clusters as glyphs of constant size on screen.
+    QVector<QPair<QPointF, int>> dronePads; ///< Servers of the current frame with several landed drones, and their number.
+    void drawPads(QPainter &painter); ///< Draws the number of landed drones next to the drone drawn on each pad.
+    const DroneFleet *fleet = nullptr; ///< Fleet engine, for its collision grid.
+    bool panning = false; ///< True while the view is dragged with the right button.
+    QPoint panStart; ///< Last mouse position of the panning.
+    double interpolation = 1.0; ///< Fraction of simulation step between the two last states of the drones.
+    QPixmap staticLayer; ///< Cached drawing of the triangles, Voronoi edges and servers.
+    bool staticLayerDirty = true; ///< True if staticLayer must be redrawn.
+    QVector<QStaticText> serverLabels; ///< Cached layout of the server names.
+    void renderStaticLayer(); ///< Draws the static geometry in staticLayer.
+    void applyTransform(QPainter &painter) const; ///< Sets the transformation from canvas coordinates to widget coordinates.
+    QRectF visibleRect() const; ///< Gets the part of the canvas shown in the widget, in canvas coordinates.
+    void invalidateView() { staticLayerDirty = true; update(); } ///< Redraws the static layer after a zoom or a pan, the geometry being unchanged.
+    ViewportIndex triangleIndex; ///< Bounding boxes of Triangle::triangles.
+    ViewportIndex edgeIndex; ///< Bounding boxes of voronoiEdges.
+    ViewportIndex serverIndex; ///< Bounding boxes of the servers and their labels.
+    bool sceneIndexDirty = true; ///< True if the viewport indices must be rebuilt.
+    QVector<int> visibleItems; ///< Result of the last viewport query.
+    void buildSceneIndex(); ///< Indexes the triangles, Voronoi edges and servers.
+    const TrajectoryReader *replay = nullptr; ///< Recording drawn in replay mode.
     float scale = 1.0f;///< Scaling factor for the canvas.
     Vector2D origin;///< Origin point for transformations.
    Voronoi* voronoi;///< Pointer to Voronoi structure.
@@ -0,0 +1,272 @@
+#include "delaunaytriangulation.h"
+#include "divideconquerdelaunay.h"
+#include "predicates.h"
+#include <algorithm>
+
+/**
+ * @brief Index of the cell (x,y) of a 2^16 x 2^16 grid along a Hilbert curve
+ */
+static quint64 hilbertIndex(quint32 x,quint32 y) {
+    const quint32 n=1u<<16;
+    quint64 d=0;
+    for (quint32 s=n/2; s>0; s/=2) {
+        const quint32 rx=(x&s)?1:0;
+        const quint32 ry=(y&s)?1:0;
+        d+=quint64(s)*s*((3*rx)^ry);
+        // rotate the quadrant
+        if (ry==0) {
+            if (rx==1) {
+                x=n-1-x;
+                y=n-1-y;
+            }
+            std::swap(x,y);
+        }
+    }
+    return d;
+}
+
+void DelaunayTriangulation::clear() {
+    vertices.clear();
+    xs.clear();
+    ys.clear();
+    faces.clear();
+    freeFaces.clear();
+    marks.clear();
+    duplicates=0;
+}
+
+double DelaunayTriangulation::orient(int a,int b,int c) const {
+    return Predicates::orient2d(xs[a],ys[a],xs[b],ys[b],xs[c],ys[c]);
+}
+
+bool DelaunayTriangulation::inCircle(const Face &f,int p) const {
+    for (int k=0; k<3; k++) {
+        if (f.v[k]!=infinite) continue;
+        // circle of a ghost face: the open half plane on the left of its edge, and the open edge
+        const int a=f.v[(k+1)%3],b=f.v[(k+2)%3];
+        const double o=orient(a,b,p);
+        if (o!=0) return o>0;
+        if (xs[a]!=xs[b]) return (xs[p]>xs[a])!=(xs[p]>xs[b]) && xs[p]!=xs[a] && xs[p]!=xs[b];
+        return (ys[p]>ys[a])!=(ys[p]>ys[b]) && ys[p]!=ys[a] && ys[p]!=ys[b];
+    }
+    return Predicates::incircle(xs[f.v[0]],ys[f.v[0]],xs[f.v[1]],ys[f.v[1]],xs[f.v[2]],ys[f.v[2]],xs[p],ys[p])>0;
+}
+
+int DelaunayTriangulation::newFace(int a,int b,int c,int na,int nb,int nc) {
+    Face f={{a,b,c},{na,nb,nc}};
+    if (!freeFaces.isEmpty()) {
+        const int i=freeFaces.takeLast();
+        faces[i]=f;
+        return i;
+    }
+    faces.append(f);
+    marks.append(0);
+    return faces.size()-1;
+}
+
+void DelaunayTriangulation::build(const QVector<Vector2D> &points) {
+    clear();
+    vertices=points;
+    const int n=vertices.size();
+    if (n<3) return;
+
+    double minX=vertices[0].x,maxX=minX,minY=vertices[0].y,maxY=minY;
+    for (const Vector2D &p:vertices) {
+        minX=qMin(minX,double(p.x));
+        maxX=qMax(maxX,double(p.x));
+        minY=qMin(minY,double(p.y));
+        maxY=qMax(maxY,double(p.y));
+    }
+    const double size=qMax(qMax(maxX-minX,maxY-minY),1.0);
+    xs.resize(n);
+    ys.resize(n);
+    for (int i=0; i<n; i++) {
+        xs[i]=vertices[i].x;
+        ys[i]=vertices[i].y;
+    }
+
+    // insertion along a Hilbert curve: consecutive points are close, so are their triangles
+    QVector<QPair<quint64,int>> order(n);
+    const double scale=65535.0/size;
+    for (int i=0; i<n; i++) {
+        order[i]=qMakePair(hilbertIndex(quint32((xs[i]-minX)*scale),quint32((ys[i]-minY)*scale)),i);
+    }
+    std::sort(order.begin(),order.end());
+
+    // first triangle: the first 2 distinct points and the first point which is not collinear with them
+    const int a=order[0].second;
+    int b=-1,c=-1;
+    for (const auto &o:order) {
+        if (b<0 && (xs[o.second]!=xs[a] || ys[o.second]!=ys[a])) b=o.second;
+        else if (b>=0 && orient(a,b,o.second)!=0) {
+            c=o.second;
+            break;
+        }
+    }
+    if (c<0) {
+        // collinear points: no face
+        QVector<QPair<double,double>> sorted(n);
+        for (int i=0; i<n; i++) sorted[i]=qMakePair(xs[i],ys[i]);
+        std::sort(sorted.begin(),sorted.end());
+        duplicates=int(sorted.end()-std::unique(sorted.begin(),sorted.end()));
+        return;
+    }
+    if (orient(a,b,c)<0) std::swap(b,c);
+
+    // the triangle and a ghost face on each of its edges
+    infinite=n;
+    faces.reserve(2*n+4);
+    marks.reserve(2*n+4);
+    newFace(a,b,c,1,2,3);
+    newFace(c,b,infinite,3,2,0);
+    newFace(a,c,infinite,1,3,0);
+    newFace(b,a,infinite,2,1,0);
+    lastFace=0;
+    stamp=0;
+    for (const auto &o:order) {
+        if (o.second!=a && o.second!=b && o.second!=c) insert(o.second);
+    }
+
+    // remove the ghost faces and compact the others
+    QVector<int> newIndex(faces.size(),-1);
+    int count=0;
+    for (int i=0; i<faces.size(); i++) {
+        if (faces[i].v[0]>=0 && !isGhost(faces[i])) newIndex[i]=count++;
+    }
+    QVector<Face> kept;
+    kept.reserve(count);
+    for (int i=0; i<faces.size(); i++) {
+        if (newIndex[i]<0) continue;
+        Face f=faces[i];
+        for (int k=0; k<3; k++) f.n[k]=newIndex[f.n[k]];
+        kept.append(f);
+    }
+    faces=kept;
+    freeFaces.clear();
+    marks.clear();
+}
+
+void DelaunayTriangulation::buildDivideAndConquer(const QVector<Vector2D> &points,WorkerPool &pool) {
+    clear();
+    vertices=points;
+    DivideConquerDelaunay triangulator(pool);
+    duplicates=triangulator.triangulate(vertices,faces);
+}
+
+int DelaunayTriangulation::locate(int p) const {
+    // visibility walk: cross an edge having p on its right, the first edge tested changes at each step.
+    // A ghost face is the end of the walk when p is outside its edge, else the walk enters the hull
+    int f=lastFace;
+    for (int steps=0,start=0; steps<=faces.size(); steps++,start++) {
+        const Face &face=faces[f];
+        int next=-1;
+        for (int k=0; k<3 && next<0; k++) {
+            const int e=(start+k)%3;
+            const int a=face.v[(e+1)%3],b=face.v[(e+2)%3];
+            if (face.v[e]==infinite) {
+                if (orient(a,b,p)>0) return f;
+                next=face.n[e];
+            } else if (a!=infinite && b!=infinite && orient(a,b,p)<0) {
+                next=face.n[e];
+            }
+        }
+        if (next<0) return f;
+        if (isGhost(faces[next])) return next;
+        f=next;
+    }
+    // cycling walk (should not happen with exact predicates): search all the faces
+    for (int i=0; i<faces.size(); i++) {
+        const Face &face=faces[i];
+        if (face.v[0]>=0 && !isGhost(face) && orient(face.v[1],face.v[2],p)>=0 && orient(face.v[2],face.v[0],p)>=0 && orient(face.v[0],face.v[1],p)>=0) return i;
+    }
+    for (int i=0; i<faces.size(); i++) {
+        if (faces[i].v[0]>=0 && isGhost(faces[i]) && inCircle(faces[i],p)) return i;
+    }
+    return lastFace;
+}
+
+void DelaunayTriangulation::insert(int p) {
+    const int start=locate(p);
+    for (int k=0; k<3; k++) {
+        const int v=faces[start].v[k];
+        if (v!=infinite && xs[v]==xs[p] && ys[v]==ys[p]) {
+            duplicates++;
+            return;
+        }
+    }
+
+    // cavity: the faces whose circumcircle contains p, connected to the face containing p
+    stamp++;
+    cavity.clear();
+    stack.clear();
+    marks[start]=stamp;
+    stack.append(start);
+    while (!stack.isEmpty()) {
+        const int f=stack.takeLast();
+        cavity.append(f);
+        for (int k=0; k<3; k++) {
+            const int nb=faces[f].n[k];
+            if (nb>=0 && marks[nb]!=stamp && inCircle(faces[nb],p)) {
+                marks[nb]=stamp;
+                stack.append(nb);
+            }
+        }
+    }
+
+    // boundary of the cavity: each edge must see p on its left, else the face behind it
+    // joins the cavity (can only happen on a degenerate input, the predicates being exact)
+    bool starShaped;
+    do {
+        starShaped=true;
+        boundary.clear();
+        for (int i=0; i<cavity.size() && starShaped; i++) {
+            const Face &f=faces[cavity[i]];
+            for (int k=0; k<3; k++) {
+                const int nb=f.n[k];
+                if (nb>=0 && marks[nb]==stamp) continue;
+                const int a=f.v[(k+1)%3],b=f.v[(k+2)%3];
+                if (a!=infinite && b!=infinite && orient(a,b,p)<=0 && nb>=0 && !isGhost(faces[nb])) {
+                    marks[nb]=stamp;
+                    cavity.append(nb);
+                    starShaped=false;
+                    break;
+                }
+                boundary.append({a,b,nb});
+            }
+        }
+    } while (!starShaped);
+
+    // fan of new faces (a,b,p) around p, in the place of the cavity faces
+    for (int f:cavity) {
+        faces[f].v[0]=-1;
+        freeFaces.append(f);
+    }
+    created.resize(boundary.size());
+    for (int i=0; i<boundary.size(); i++) {
+        const BoundaryEdge &e=boundary[i];
+        const int f=newFace(e.a,e.b,p,-1,-1,e.outside);
+        marks[f]=0;
+        created[i]=f;
+        if (e.outside>=0) {
+            // the outside face pointed to a cavity face across this edge
+            Face &o=faces[e.outside];
+            for (int k=0; k<3; k++) {
+                if (o.v[(k+1)%3]==e.b && o.v[(k+2)%3]==e.a) {
+                    o.n[k]=f;
+                    break;
+                }
+            }
+        }
+    }
+    // links between the new faces: the face of edge (a,b) shares (b,p) with the face starting at b
+    for (int i=0; i<boundary.size(); i++) {
+        for (int j=0; j<boundary.size(); j++) {
+            if (boundary[j].a==boundary[i].b) {
+                faces[created[i]].n[0]=created[j];
+                faces[created[j]].n[1]=created[i];
+                break;
+            }
+        }
+    }
+    lastFace=created.last();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file delaunaytriangulation.h
+ * @brief Incremental Delaunay triangulation of a set of points (Bowyer-Watson).
+ */
+#ifndef DELAUNAYTRIANGULATION_H
+#define DELAUNAYTRIANGULATION_H
+
+#include <QVector>
+#include "vector2d.h"
+
+class WorkerPool;
+
+/**
+ * @class DelaunayTriangulation
+ * @brief The DelaunayTriangulation class builds the Delaunay triangulation of the convex hull of a set of points.
+ *
+ * The points are inserted one by one in a triangulation closed by a vertex at infinity: each edge of the
+ * convex hull has a ghost face joining it to this vertex, whose circle is the open half plane outside
+ * the edge (and the open edge itself). A point outside the hull is then inserted like an interior one,
+ * so the hull is exact whatever the shape of the points, even for nearly collinear ones. For each point,
+ * the triangle containing it is found by walking from the last created triangle, then all the triangles
+ * whose circumcircle contains the point (the cavity) are replaced by a fan of triangles around the point.
+ * The points are inserted in the order of a Hilbert curve, so the walks are short: the expected cost is
+ * O(n log n), dominated by the sort.
+ *
+ * Each face stores its vertices in counterclockwise order (for a y axis going up) and, for each vertex,
+ * the neighbor face across the opposite edge. The ghost faces are removed at the end. Collinear points
+ * have no face.
+ */
+class DelaunayTriangulation {
+public:
+    /**
+     * @brief A triangle of the triangulation
+     */
+    struct Face {
+        int v[3]; ///< indices of the vertices, counterclockwise
+        int n[3]; ///< n[i] is the face across the edge opposite to v[i], -1 on the convex hull
+    };
+
+    DelaunayTriangulation() {}
+
+    /**
+     * @brief Triangulate a set of points, the previous triangulation is replaced
+     * @param points the vertices, a point equal to a previous one is ignored
+     */
+    void build(const QVector<Vector2D> &points);
+    /**
+     * @brief Triangulate a set of points by divide and conquer on the threads of a pool (see DivideConquerDelaunay),
+     * the previous triangulation is replaced. Faster than build() for very large sets with several cores.
+     * @param points the vertices, a point equal to a previous one is ignored
+     * @param pool threads running the triangulation
+     */
+    void buildDivideAndConquer(const QVector<Vector2D> &points,WorkerPool &pool);
+    /**
+     * @brief Remove all the vertices and faces
+     */
+    void clear();
+
+    /**
+     * @brief Get the vertices, in the order of the points given to build()
+     */
+    inline const QVector<Vector2D> &getVertices() const { return vertices; }
+    /**
+     * @brief Get a pointer on a vertex, valid until the next build() or clear()
+     */
+    inline Vector2D *getVertexPtr(int i) { return &vertices[i]; }
+    /**
+     * @brief Get the faces of the triangulation
+     */
+    inline const QVector<Face> &getFaces() const { return faces; }
+    /**
+     * @brief Get the number of points ignored because they are equal to a previous one
+     */
+    inline int getDuplicateCount() const { return duplicates; }
+
+private:
+    void insert(int p);
+    int locate(int p) const;
+    int newFace(int a,int b,int c,int na,int nb,int nc);
+    double orient(int a,int b,int c) const;
+    bool inCircle(const Face &f,int p) const;
+    inline bool isGhost(const Face &f) const { return f.v[0]==infinite || f.v[1]==infinite || f.v[2]==infinite; }
+
+    QVector<Vector2D> vertices; ///< points of the triangulation
+    QVector<double> xs,ys;      ///< coordinates of the vertices
+    QVector<Face> faces;        ///< faces, the removed ones have v[0]<0 during the build
+    int infinite=0;             ///< index of the vertex at infinity of the ghost faces during the build
+    QVector<int> freeFaces;     ///< indices of the removed faces, reused first
+    QVector<quint32> marks;     ///< cavity stamp of each face
+    quint32 stamp=0;            ///< stamp of the current insertion
+    int lastFace=0;             ///< start of the next walk
+    int duplicates=0;           ///< number of ignored points
+
+    // buffers of an insertion, kept to avoid allocations
+    QVector<int> cavity;                   ///< faces whose circumcircle contains the point
+    QVector<int> stack;                    ///< faces to visit around the cavity
+    struct BoundaryEdge { int a,b,outside; };
+    QVector<BoundaryEdge> boundary;        ///< edges of the cavity, counterclockwise
+    QVector<int> created;                  ///< new face of each boundary edge
+};
+
+#endif // DELAUNAYTRIANGULATION_H
@@ -0,0 +1,281 @@
+#include "divideconquerdelaunay.h"
+#include "predicates.h"
+#include <algorithm>
+
+bool DivideConquerDelaunay::ccw(int a,int b,int c) const {
+    return Predicates::orient2d(xs[a],ys[a],xs[b],ys[b],xs[c],ys[c])>0;
+}
+
+bool DivideConquerDelaunay::inCircle(int a,int b,int c,int d) const {
+    return Predicates::incircle(xs[a],ys[a],xs[b],ys[b],xs[c],ys[c],xs[d],ys[d])>0;
+}
+
+DivideConquerDelaunay::Edge *DivideConquerDelaunay::makeEdge(int a,int b,EdgePool &edges) {
+    edges.emplace_back();
+    Edge *e=edges.back().e;
+    for (int i=0; i<4; i++) {
+        e[i].rot=&e[(i+1)%4];
+        e[i].face=-1;
+        e[i].alive=true;
+    }
+    e[0].next=&e[0];
+    e[2].next=&e[2];
+    e[1].next=&e[3];
+    e[3].next=&e[1];
+    e[0].org=a;
+    e[2].org=b;
+    e[1].org=e[3].org=-1;
+    return &e[0];
+}
+
+void DivideConquerDelaunay::splice(Edge *a,Edge *b) {
+    Edge *alpha=a->next->rot;
+    Edge *beta=b->next->rot;
+    std::swap(a->next,b->next);
+    std::swap(alpha->next,beta->next);
+}
+
+DivideConquerDelaunay::Edge *DivideConquerDelaunay::connect(Edge *a,Edge *b,EdgePool &edges) {
+    // new edge from the destination of a to the origin of b, in the face on the left of both
+    Edge *e=makeEdge(a->dest(),b->org,edges);
+    splice(e,a->lnext());
+    splice(e->sym(),b);
+    return e;
+}
+
+void DivideConquerDelaunay::deleteEdge(Edge *e) {
+    splice(e,e->oprev());
+    splice(e->sym(),e->sym()->oprev());
+    e->alive=e->sym()->alive=false;
+}
+
+DivideConquerDelaunay::Hull DivideConquerDelaunay::divide(int lo,int hi,EdgePool &edges) {
+    const int n=hi-lo;
+    if (n==2) {
+        Edge *a=makeEdge(lo,lo+1,edges);
+        return Hull(a,a->sym());
+    }
+    if (n==3) {
+        const int s1=lo,s2=lo+1,s3=lo+2;
+        Edge *a=makeEdge(s1,s2,edges);
+        Edge *b=makeEdge(s2,s3,edges);
+        splice(a->sym(),b);
+        if (ccw(s1,s2,s3)) {
+            connect(b,a,edges);
+            return Hull(a,b->sym());
+        }
+        if (ccw(s1,s3,s2)) {
+            Edge *c=connect(b,a,edges);
+            return Hull(c->sym(),c);
+        }
+        // collinear points: no triangle
+        return Hull(a,b->sym());
+    }
+    const int mid=lo+n/2;
+    const Hull left=divide(lo,mid,edges);
+    const Hull right=divide(mid,hi,edges);
+    return merge(left,right,edges);
+}
+
+bool DivideConquerDelaunay::fromFaces(const DelaunayTriangulation &mesh,int lo,EdgePool &edges,Hull &hull) {
+    const QVector<DelaunayTriangulation::Face> &faces=mesh.getFaces();
+    const int k=mesh.getVertices().size();
+    if (faces.isEmpty() || mesh.getDuplicateCount()>0) return false;
+
+    // the boundary must be a convex polygon through all the vertices of the hull: one hull edge leaves
+    // each of them, and the faces cover all the vertices (Euler: 2k-2-h faces for h hull edges)
+    QVector<int> hullNext(k,-1);
+    QVector<bool> used(k,false);
+    int h=0;
+    for (const DelaunayTriangulation::Face &f:faces) {
+        for (int i=0; i<3; i++) {
+            used[f.v[i]]=true;
+            if (f.n[i]>=0) continue;
+            const int a=f.v[(i+1)%3];
+            if (hullNext[a]>=0) return false;
+            hullNext[a]=f.v[(i+2)%3];
+            h++;
+        }
+    }
+    if (faces.size()!=2*k-2-h || used.contains(false)) return false;
+    for (int v=0; v<k; v++) {
+        if (hullNext[v]<0) continue;
+        const int w=hullNext[v];
+        if (hullNext[w]<0 || ccw(lo+hullNext[w],lo+w,lo+v)) return false;
+    }
+
+    // one quad-edge per edge: edge[3f+i] is the edge opposite to v[i], with the face f on its left
+    const size_t first=edges.size();
+    QVector<Edge*> edge(3*faces.size(),nullptr);
+    QVector<Edge*> outRight(k,nullptr),outLeft(k,nullptr);
+    for (int f=0; f<faces.size(); f++) {
+        const DelaunayTriangulation::Face &face=faces[f];
+        for (int i=0; i<3; i++) {
+            const int g=face.n[i];
+            if (g>=0 && g<f) continue;
+            Edge *e=makeEdge(lo+face.v[(i+1)%3],lo+face.v[(i+2)%3],edges);
+            edge[3*f+i]=e;
+            if (g<0) {
+                outRight[face.v[(i+1)%3]]=e;
+                outLeft[face.v[(i+2)%3]]=e->sym();
+                continue;
+            }
+            for (int j=0; j<3; j++) {
+                if (faces[g].n[j]==f) edge[3*g+j]=e->sym();
+            }
+        }
+    }
+    // rings around the vertices: in a counterclockwise face (a,b,c), b->c follows a->b around a
+    for (int f=0; f<faces.size(); f++) {
+        for (int i=0; i<3; i++) edge[3*f+(i+2)%3]->next=edge[3*f+(i+1)%3]->sym();
+    }
+    for (int v=0; v<k; v++) {
+        if (outLeft[v]) outLeft[v]->next=outRight[v];
+    }
+    // rings of the dual edges: Onext(Rot(Onext(e)))=InvRot(e)
+    for (EdgePool::iterator it=edges.begin()+first; it!=edges.end(); ++it) {
+        for (Edge *e:{&it->e[0],&it->e[2]}) e->next->rot->next=e->invRot();
+    }
+    // the leftmost and rightmost vertices are the first and the last ones
+    hull=Hull(outRight[0],outLeft[k-1]);
+    return true;
+}
+
+DivideConquerDelaunay::Hull DivideConquerDelaunay::triangulateBlock(int lo,int hi,EdgePool &edges) {
+    // the sequential engine is faster than the recursion on large blocks
+    if (hi-lo>=leafSize) {
+        QVector<Vector2D> points(hi-lo);
+        for (int i=lo; i<hi; i++) points[i-lo]=Vector2D(xs[i],ys[i]);
+        DelaunayTriangulation mesh;
+        mesh.build(points);
+        Hull hull;
+        if (fromFaces(mesh,lo,edges,hull)) return hull;
+    }
+    // small or degenerate block (collinear points)
+    return divide(lo,hi,edges);
+}
+
+DivideConquerDelaunay::Hull DivideConquerDelaunay::merge(Hull left,Hull right,EdgePool &edges) {
+    Edge *ldo=left.first,*ldi=left.second;
+    Edge *rdi=right.first,*rdo=right.second;
+
+    // lower common tangent of the two hulls
+    for (;;) {
+        if (ccw(rdi->org,ldi->org,ldi->dest())) ldi=ldi->lnext();
+        else if (ccw(ldi->org,rdi->dest(),rdi->org)) rdi=rdi->rprev();
+        else break;
+    }
+    Edge *basel=connect(rdi->sym(),ldi,edges);
+    if (ldi->org==ldo->org) ldo=basel->sym();
+    if (rdi->org==rdo->org) rdo=basel;
+
+    // zip the triangulations from bottom to top: each step adds the cross edge whose circle is empty
+    auto valid=[&](Edge *e) { return ccw(e->dest(),basel->dest(),basel->org); };
+    for (;;) {
+        Edge *lcand=basel->sym()->next;
+        if (valid(lcand)) {
+            while (inCircle(basel->dest(),basel->org,lcand->dest(),lcand->next->dest())) {
+                Edge *t=lcand->next;
+                deleteEdge(lcand);
+                lcand=t;
+            }
+        }
+        Edge *rcand=basel->oprev();
+        if (valid(rcand)) {
+            while (inCircle(basel->dest(),basel->org,rcand->dest(),rcand->oprev()->dest())) {
+                Edge *t=rcand->oprev();
+                deleteEdge(rcand);
+                rcand=t;
+            }
+        }
+        const bool lvalid=valid(lcand),rvalid=valid(rcand);
+        if (!lvalid && !rvalid) break;
+        if (!lvalid || (rvalid && inCircle(lcand->dest(),lcand->org,rcand->org,rcand->dest()))) {
+            basel=connect(rcand,basel->sym(),edges);
+        } else {
+            basel=connect(basel->sym(),lcand->sym(),edges);
+        }
+    }
+    return Hull(ldo,rdo);
+}
+
+int DivideConquerDelaunay::triangulate(const QVector<Vector2D> &points,QVector<DelaunayTriangulation::Face> &faces) {
+    faces.clear();
+    blocks.clear();
+    const int n=points.size();
+
+    // sort by x then y, the first of equal points is kept
+    QVector<int> order(n);
+    for (int i=0; i<n; i++) order[i]=i;
+    std::stable_sort(order.begin(),order.end(),[&](int a,int b) {
+        return points[a].x<points[b].x || (points[a].x==points[b].x && points[a].y<points[b].y);
+    });
+    order.erase(std::unique(order.begin(),order.end(),[&](int a,int b) {
+        return points[a]==points[b];
+    }),order.end());
+    const int m=order.size();
+    const int duplicates=n-m;
+    if (m<3) return duplicates;
+
+    // the vertices are numbered in the sorted order, so the neighbors are close in memory
+    xs.resize(m);
+    ys.resize(m);
+    for (int i=0; i<m; i++) {
+        xs[i]=points[order[i]].x;
+        ys[i]=points[order[i]].y;
+    }
+
+    // blocks: a power of 2, at least one per thread, of at least 64 points
+    const int minBlock=64;
+    int blockCount=1;
+    while (blockCount<pool.getThreadCount() && m/(2*blockCount)>=minBlock) blockCount*=2;
+    blocks.resize(blockCount);
+    QVector<Hull> hulls(blockCount);
+    pool.parallelFor(blockCount,1,[&](int begin,int end) {
+        for (int b=begin; b<end; b++) {
+            hulls[b]=triangulateBlock(int(qint64(m)*b/blockCount),int(qint64(m)*(b+1)/blockCount),blocks[b]);
+        }
+    });
+    // merges level by level, block b absorbs block b+step
+    for (int step=1; step<blockCount; step*=2) {
+        pool.parallelFor(blockCount/(2*step),1,[&](int begin,int end) {
+            for (int p=begin; p<end; p++) {
+                const int b=2*step*p;
+                hulls[b]=merge(hulls[b],hulls[b+step],blocks[b]);
+            }
+        });
+    }
+
+    // faces: the left cycles of 3 edges turning counterclockwise
+    QVector<Edge*> faceEdges;
+    faceEdges.reserve(2*m);
+    for (EdgePool &edges:blocks) {
+        for (QuadEdge &q:edges) {
+            if (!q.e[0].alive) continue;
+            for (Edge *e:{&q.e[0],&q.e[2]}) {
+                if (e->face!=-1) continue;
+                Edge *e1=e->lnext(),*e2=e1->lnext();
+                if (e2->lnext()==e && ccw(e->org,e1->org,e2->org)) {
+                    e->face=e1->face=e2->face=faceEdges.size();
+                    faceEdges.append(e);
+                } else {
+                    e->face=-2;
+                }
+            }
+        }
+    }
+    faces.resize(faceEdges.size());
+    for (int f=0; f<faceEdges.size(); f++) {
+        Edge *e=faceEdges[f],*e1=e->lnext(),*e2=e1->lnext();
+        DelaunayTriangulation::Face &face=faces[f];
+        face.v[0]=order[e->org];
+        face.v[1]=order[e1->org];
+        face.v[2]=order[e2->org];
+        // the edge leaving v[i] is opposite to v[i+2]
+        face.n[2]=qMax(e->sym()->face,-1);
+        face.n[0]=qMax(e1->sym()->face,-1);
+        face.n[1]=qMax(e2->sym()->face,-1);
+    }
+    blocks.clear();
+    return duplicates;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file divideconquerdelaunay.h
+ * @brief Parallel divide and conquer Delaunay triangulation (Guibas-Stolfi).
+ */
+#ifndef DIVIDECONQUERDELAUNAY_H
+#define DIVIDECONQUERDELAUNAY_H
+
+#include <QVector>
+#include <QPair>
+#include <deque>
+#include <vector>
+#include "delaunaytriangulation.h"
+#include "workerpool.h"
+
+/**
+ * @class DivideConquerDelaunay
+ * @brief The DivideConquerDelaunay class triangulates a set of points by divide and conquer on several threads.
+ *
+ * The points are sorted by x then y and cut in blocks of consecutive points, a power of 2 at least equal to
+ * the number of threads. The blocks are triangulated in parallel, the large ones by the incremental
+ * DelaunayTriangulation whose faces are converted to quad-edges, the small or degenerate ones by the
+ * recursive algorithm of Guibas and Stolfi. Then the neighbor triangulations are merged two by two, the merges of a
+ * level being independent and also run in parallel, until one triangulation remains. The triangulations
+ * are stored as quad-edges, each block allocating the edges it creates in its own pool.
+ *
+ * A merge only rebuilds the triangles along the cut, so most of the work is in the blocks; the last
+ * merge and the extraction of the faces are sequential.
+ */
+class DivideConquerDelaunay {
+public:
+    /**
+     * @brief Constructs a triangulator
+     * @param p_pool threads running the blocks and the merges
+     */
+    explicit DivideConquerDelaunay(WorkerPool &p_pool):pool(p_pool) {}
+
+    /**
+     * @brief Triangulate a set of points
+     * @param points the vertices, a point equal to a previous one is ignored
+     * @param faces receives the faces, in the format of DelaunayTriangulation: counterclockwise, with their neighbors
+     * @return the number of ignored points
+     */
+    int triangulate(const QVector<Vector2D> &points,QVector<DelaunayTriangulation::Face> &faces);
+
+private:
+    /**
+     * @brief A directed edge of a quad-edge: a primal edge (org is a vertex) or a dual one (org is -1)
+     */
+    struct Edge {
+        Edge *next;  ///< next edge counterclockwise around the origin (Onext)
+        Edge *rot;   ///< the edge rotated by 90 degrees counterclockwise
+        int org;     ///< origin vertex, -1 for a dual edge
+        int face;    ///< face on the left once extracted, -1 before, -2 for the outer face
+        bool alive;  ///< false once deleted
+
+        inline Edge *sym() const { return rot->rot; }
+        inline Edge *invRot() const { return rot->rot->rot; }
+        inline Edge *oprev() const { return rot->next->rot; }
+        inline Edge *lnext() const { return invRot()->next->rot; }
+        inline Edge *rprev() const { return sym()->next; }
+        inline int dest() const { return sym()->org; }
+    };
+    /**
+     * @brief An undirected edge: the 2 directions of the edge and of its dual
+     */
+    struct QuadEdge {
+        Edge e[4];
+    };
+    typedef std::deque<QuadEdge> EdgePool;  ///< a deque keeps the edges in place when it grows
+    typedef QPair<Edge*,Edge*> Hull;        ///< counterclockwise hull edge leaving the leftmost vertex, clockwise one leaving the rightmost vertex
+
+    static const int leafSize=256;  ///< smallest block triangulated by the incremental engine
+
+    Hull triangulateBlock(int lo,int hi,EdgePool &edges);
+    bool fromFaces(const DelaunayTriangulation &mesh,int lo,EdgePool &edges,Hull &hull);
+    Hull divide(int lo,int hi,EdgePool &edges);
+    Hull merge(Hull left,Hull right,EdgePool &edges);
+    Edge *makeEdge(int a,int b,EdgePool &edges);
+    Edge *connect(Edge *a,Edge *b,EdgePool &edges);
+    static void splice(Edge *a,Edge *b);
+    static void deleteEdge(Edge *e);
+    bool ccw(int a,int b,int c) const;
+    bool inCircle(int a,int b,int c,int d) const;
+
+    WorkerPool &pool;              ///< threads of the blocks and merges
+    QVector<double> xs,ys;         ///< coordinates of the distinct points, sorted by x then y
+    std::vector<EdgePool> blocks;  ///< edges created by each block and its merges
+};
+
+#endif // DIVIDECONQUERDELAUNAY_H
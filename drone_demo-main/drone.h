@@ -6,126 +6,116 @@
 #ifndef DRONE_H
 #define DRONE_H
 
-#include <QWidget>
-#include <QProgressBar>
+#include <QString>
 #include <vector2d.h>
-#include <QImage>
+#include "dronefleet.h"
 
-class Drone : public QWidget {
+class Server;
 
-    Q_OBJECT
+/**
+ * @class Drone
+ * @brief The Drone class is a handle on a drone of the fleet, used by the canvas and the servers.
+ *
+ * The drone has no widget: the list of the drones is drawn by a DroneDelegate over a DroneListModel.
+ */
+class Drone : public DroneModel {
 public:
 
-    const double maxSpeed=50; ///< max speed in pixels per second
-    const double maxPower=200; ///< max power of drone motors
-    const double takeoffSpeed=2.5; ///< unit/s
-    const double hoveringHeight=5; ///< units
-    const double coefCollision=1000; ///< coefficient for collision avoidment
-    const double damping=0.2;        ///< damping for motion simulation
-    const double chargingSpeed=10;   ///< speed of charging (power/s)
-    const double powerConsumption=5; ///< speed of consumption (power/s)
-    enum droneStatus { landed,takeoff,landing,hovering,turning,flying};
-     void setServerName(const QString& name);
+    /**
+     * @brief setServer set the server managing the drone, done by Server::addDrone
+     * @param p_server: the server (nullptr if none)
+     */
+    inline void setServer(Server *p_server) { server = p_server; }
+    /**
+     * @brief getServer get the server managing the drone, the drone lands on it
+     * @return the server, nullptr if the drone has not been assigned to a server
+     */
+    inline Server *getServer() const { return server; }
     QString getServerName() const;
     /**
-     * @brief Drone constructor
-     * @param p_name name of the drone
-     * @param parent parent widget
+     * @brief setCountedLanded mark the drone as counted in the landed drones of its server, done by Server
      */
-    explicit Drone(const QString &p_name,QWidget *parent = nullptr);
+    inline void setCountedLanded(bool counted) { countedLanded = counted; }
     /**
-     * Drone destructor
+     * @brief isCountedLanded get if the drone is counted in the landed drones of its server
      */
-    ~Drone();
+    inline bool isCountedLanded() const { return countedLanded; }
+    /**
+     * @brief Drone constructor
+     * @param p_fleet fleet engine holding the state of the drone
+     * @param p_index index of the drone in the fleet
+     */
+    Drone(DroneFleet *p_fleet,int p_index);
     /**
      * @brief Make the drone takeoff to move to a target position
      */
-    inline void start() { status=takeoff; height=0; repaint(); }
+    void start();
     /**
      * @brief Ask for landing
      */
-    inline void stop() { status=landing; }
+    inline void stop() { fleet->stop(index); }
     /**
      * @brief set the speed of fly of the drone
      * @param s: speed
      */
-    inline void setSpeed(double s) { speedSetpoint=(s>maxSpeed?maxSpeed:s); }
+    inline void setSpeed(double s) { fleet->setSpeed(index,s); }
     /**
      * @brief setInitialPosition set the initial position of the drone (takeoff place)
      * @param pos: the position
      */
-    inline void setInitialPosition(const Vector2D& pos) { if (status==landed) position=pos; }
+    inline void setInitialPosition(const Vector2D& pos) { fleet->setInitialPosition(index,pos); }
     /**
      * @brief setGoalPosition set the goal position of the drone (landing place)
      * @param pos: the position
      */
-    inline void setGoalPosition(const Vector2D& pos) { goalPosition=pos; }
+    inline void setGoalPosition(const Vector2D& pos) { fleet->setGoalPosition(index,pos); }
     /**
      * @brief getPosition get the current position of the drone
      * @return the position
      */
-    inline Vector2D getPosition() { return position; }
+    inline Vector2D getPosition() { return fleet->getPosition(index); }
+    /**
+     * @brief getInterpolatedPosition get the position of the drone between the two last simulation steps
+     * @param alpha: fraction of step elapsed since the last one, in [0,1]
+     * @return the position
+     */
+    inline Vector2D getInterpolatedPosition(double alpha) { return fleet->getInterpolatedPosition(index,alpha); }
     /**
      * @brief getStatus get the current status of the drone
      * @return the status
      */
-    inline droneStatus getStatus() { return status; }
+    inline droneStatus getStatus() { return fleet->getStatus(index); }
     /**
      * @brief getName get the name of the drone
      * @return the name
      */
-    inline QString getName() { return name; }
+    inline QString getName() { return fleet->getName(index); }
     /**
     /** * @brief getAzimut get the direction of motion of the drone (angle in degree relatively to the y direction)
     /** * @return the angle in degree
     */
-    inline double getAzimut() { return azimut; }
+    inline double getAzimut() { return fleet->getAzimut(index); }
     /**
      * @brief get the Power rank between 0 and 100
      * @return the rank
      */
-    inline double getPower() { return 100.0*power/maxPower; }
-    void paintEvent(QPaintEvent*) override;
-    void resizeEvent(QResizeEvent *event) override;
-
-    void update(double dt);
-    /**
-     * @brief Prepare data for collision detections
-     */
-    void initCollision();
+    inline double getPower() { return fleet->getPower(index); }
     /**
-     * @brief Add a collision force
-     * @param A: position of the other drone to test
-     * @param threshold: distance of collision detection
+     * @brief getIndex get the index of the drone in the fleet
+     * @return the index
      */
-    void addCollision(const Vector2D& A,float threshold);
+    inline int getIndex() const { return index; }
     /**
      * @brief Get if a collision has occurred
      * @return true if collision
      */
-    bool hasCollision() { return showCollision; }
-signals:
+    bool hasCollision() { return fleet->hasCollision(index); }
 
 private:
-    const int compasSize = 48; ///< size of the compas image (compasSize x compasSize)
-    const int barSpace = 150; ///< minimum size of the ProgressBar
-    droneStatus status;       ///< status of the drone
-    double height;            ///< current height of the drone
-    QString name;             ///< name of the drone
-    QProgressBar *speedPB;    ///< progress bar widget for the speed
-    QProgressBar *powerPB;    ///< progress bar widget for the power
-    Vector2D position;        ///< current position of the drone
-    Vector2D goalPosition;    ///< goal position for the drone
-    Vector2D direction;       ///< current direction
-    Vector2D V;               ///< current speed vector
-    Vector2D ForceCollision;  ///< force generated by the collision detection
-    double speed;             ///< current speed
-    double speedSetpoint;     ///< speed to reach if possible
-    double power;             ///< current power
-    double azimut;            ///< rotation angle of the drone
-    QImage compasImg,stopImg,takeoffImg,landingImg;
-    bool showCollision;       ///< true if a collision is detected
-    QString serverName; // Example member variable
+    DroneFleet *fleet;        ///< engine holding the state of the drone
+    int index;                ///< index of the drone in the fleet
+    Server *server=nullptr;   ///< server managing the drone
+    bool countedLanded=false; ///< true if counted in the landed drones of its server
 
 };
 
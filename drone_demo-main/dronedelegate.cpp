@@ -0,0 +1,71 @@
+#include "dronedelegate.h"
+#include "dronelistmodel.h"
+#include <QApplication>
+#include <QPainter>
+#include <QStyle>
+#include <QStyleOption>
+
+DroneDelegate::DroneDelegate(QObject *parent)
+    : QStyledItemDelegate(parent) {
+    // loaded once for all the drones
+    compasImg.load("../../media/compas.png");
+    stopImg.load("../../media/stop.png");
+    takeoffImg.load("../../media/takeoff.png");
+    landingImg.load("../../media/landing.png");
+}
+
+void DroneDelegate::paint(QPainter *painter,const QStyleOptionViewItem &option,const QModelIndex &index) const {
+    painter->save();
+    if (option.state & QStyle::State_Selected) painter->fillRect(option.rect,option.palette.highlight());
+
+    const QRect rect(option.rect.left(),option.rect.top(),compasSize,compasSize);
+    switch (index.data(DroneListModel::StatusRole).toInt()) {
+        case DroneModel::landed: painter->drawImage(rect,stopImg); break;
+        case DroneModel::takeoff: painter->drawImage(rect,takeoffImg); break;
+        case DroneModel::landing: painter->drawImage(rect,landingImg); break;
+        default : {
+            painter->drawImage(rect,compasImg);
+            // draw the compass needle
+            const QPointF points[3] = { QPointF(-compasSize/5.0,0),QPointF(compasSize/5.0,0),QPointF(0,compasSize/2.2) };
+            painter->save();
+            painter->setRenderHint(QPainter::Antialiasing);
+            painter->translate(QRectF(rect).center());
+            painter->rotate(index.data(DroneListModel::AzimutRole).toDouble());
+            painter->setBrush(Qt::white);
+            painter->setPen(Qt::black);
+            painter->drawPolygon(points,3);
+            painter->setBrush(Qt::red);
+            painter->rotate(180);
+            painter->drawPolygon(points,3);
+            painter->restore();
+        }
+    }
+
+    const int x=option.rect.left()+compasSize+5;
+    const int w=option.rect.width()-compasSize-5;
+    drawBar(painter,option,QRect(x,option.rect.top(),w,compasSize/2),
+            qRound(index.data(DroneListModel::SpeedRole).toDouble()),int(DroneModel::maxSpeed),
+            index.data(Qt::DisplayRole).toString()+" speed %p%");
+    drawBar(painter,option,QRect(x,option.rect.top()+compasSize/2,w,compasSize/2),
+            qRound(index.data(DroneListModel::PowerRole).toDouble()),int(DroneModel::maxPower),"power %p%");
+    painter->restore();
+}
+
+void DroneDelegate::drawBar(QPainter *painter,const QStyleOptionViewItem &option,const QRect &rect,
+                            int value,int maximum,const QString &format) const {
+    QStyleOptionProgressBar bar;
+    bar.initFrom(option.widget);
+    bar.rect=rect;
+    bar.minimum=0;
+    bar.maximum=maximum;
+    bar.progress=qBound(0,value,maximum);
+    bar.textVisible=true;
+    bar.textAlignment=Qt::AlignCenter;
+    bar.text=QString(format).replace("%p",QString::number(100*bar.progress/qMax(1,maximum)));
+    QStyle *style=option.widget?option.widget->style():QApplication::style();
+    style->drawControl(QStyle::CE_ProgressBar,&bar,painter,option.widget);
+}
+
+QSize DroneDelegate::sizeHint(const QStyleOptionViewItem &,const QModelIndex &) const {
+    return QSize(barSpace+compasSize,compasSize);
+}
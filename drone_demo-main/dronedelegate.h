@@ -0,0 +1,38 @@
+/**
+ * @file dronedelegate.h
+ * @brief Drawing of a row of the list of the drones.
+ */
+#ifndef DRONEDELEGATE_H
+#define DRONEDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QImage>
+
+/**
+ * @class DroneDelegate
+ * @brief The DroneDelegate class paints a drone of a DroneListModel: status or compass, speed and power bars.
+ *
+ * It replaces a widget with two QProgressBar per drone: the bars are drawn by the style
+ * of the view, and only for the rows in the viewport.
+ */
+class DroneDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    explicit DroneDelegate(QObject *parent=nullptr);
+
+    void paint(QPainter *painter,const QStyleOptionViewItem &option,const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option,const QModelIndex &index) const override;
+
+private:
+    /**
+     * @brief Draw a progress bar of the style in a rectangle
+     */
+    void drawBar(QPainter *painter,const QStyleOptionViewItem &option,const QRect &rect,
+                 int value,int maximum,const QString &format) const;
+
+    const int compasSize = 48; ///< size of the compas image (compasSize x compasSize)
+    const int barSpace = 150; ///< minimum size of the progress bars
+    QImage compasImg,stopImg,takeoffImg,landingImg;
+};
+
+#endif // DRONEDELEGATE_H
@@ -0,0 +1,21 @@
+#include "droneevents.h"
+
+void DroneEventQueue::reset(int n) {
+    queue=std::priority_queue<Event,std::vector<Event>,Later>();
+    stamps.fill(0,n);
+}
+
+void DroneEventQueue::schedule(int drone,double time,eventType type) {
+    const quint32 stamp=++stamps[drone];
+    queue.push({time,drone,stamp,type});
+}
+
+bool DroneEventQueue::pop(double until,Event &e) {
+    while (!queue.empty() && queue.top().time<=until) {
+        e=queue.top();
+        queue.pop();
+        if (e.stamp==stamps[e.drone]) return true;
+        // cancelled event
+    }
+    return false;
+}
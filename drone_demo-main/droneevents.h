@@ -0,0 +1,77 @@
+/**
+ * @file droneevents.h
+ * @brief Priority queue of the predicted status changes of the drones.
+ */
+#ifndef DRONEEVENTS_H
+#define DRONEEVENTS_H
+
+#include <QVector>
+#include <queue>
+#include <vector>
+
+/**
+ * @class DroneEventQueue
+ * @brief The DroneEventQueue class stores at most one pending status change per drone, sorted by time.
+ *
+ * Scheduling a new event for a drone cancels its previous one: each drone has a stamp which is
+ * incremented at each scheduling, and an event whose stamp is not the current stamp of its
+ * drone is dropped when it reaches the top of the queue.
+ */
+class DroneEventQueue {
+public:
+    enum eventType { takeoffDone,landingDone,lowBattery };
+
+    /**
+     * @brief A predicted status change
+     */
+    struct Event {
+        double time;    ///< simulated time of the change
+        int drone;      ///< index of the drone
+        quint32 stamp;  ///< stamp of the drone when the event was scheduled
+        eventType type; ///< kind of change
+    };
+
+    /**
+     * @brief Remove all the events
+     * @param n number of drones
+     */
+    void reset(int n);
+    /**
+     * @brief Add a drone without event
+     */
+    inline void addDrone() { stamps.append(0); }
+    /**
+     * @brief Schedule a status change of a drone, replacing its pending event
+     */
+    void schedule(int drone,double time,eventType type);
+    /**
+     * @brief Cancel the pending event of a drone
+     */
+    inline void cancel(int drone) { stamps[drone]++; }
+    /**
+     * @brief Take the next valid event due at or before a time
+     * @param until limit time
+     * @param e the event taken
+     * @return false if no event is due
+     */
+    bool pop(double until,Event &e);
+    /**
+     * @brief Get the number of events in the queue (including the cancelled ones)
+     */
+    inline int size() const { return int(queue.size()); }
+
+private:
+    /**
+     * @brief Order of the events: earliest first, then lowest drone index
+     */
+    struct Later {
+        bool operator()(const Event &a,const Event &b) const {
+            return a.time>b.time || (a.time==b.time && a.drone>b.drone);
+        }
+    };
+
+    std::priority_queue<Event,std::vector<Event>,Later> queue; ///< pending events
+    QVector<quint32> stamps;                                   ///< current stamp of each drone
+};
+
+#endif // DRONEEVENTS_H
@@ -0,0 +1,426 @@
+#include "dronefleet.h"
+#include "profiler.h"
+#include <cmath>
+#include <random>
+#include <algorithm>
+
+int DroneFleet::add(const QString &name,const Vector2D &pos) {
+    names.append(name);
+    status.append(landed);
+    posX.append(pos.x);
+    posY.append(pos.y);
+    prevX.append(pos.x);
+    prevY.append(pos.y);
+    goalX.append(550);
+    goalY.append(600);
+    vX.append(0);
+    vY.append(0);
+    fcX.append(0);
+    fcY.append(0);
+    height.append(0);
+    speed.append(0);
+    speedSetpoint.append(0);
+    power.append(maxPower/2.0);
+    anchorTime.append(time);
+    azimut.append(0);
+    collision.append(0);
+    events.addDrone();
+    return names.size()-1;
+}
+
+void DroneFleet::clear() {
+    names.clear();
+    status.clear();
+    posX.clear();
+    posY.clear();
+    prevX.clear();
+    prevY.clear();
+    goalX.clear();
+    goalY.clear();
+    vX.clear();
+    vY.clear();
+    fcX.clear();
+    fcY.clear();
+    height.clear();
+    speed.clear();
+    speedSetpoint.clear();
+    power.clear();
+    anchorTime.clear();
+    azimut.clear();
+    collision.clear();
+    grid.clear();
+    collisionPairs=0;
+    time=0;
+    active.clear();
+    activeChanged=false;
+    landings.clear();
+    flyingSet.clear();
+    flyingBlocks.clear();
+    flyingCount=0;
+    flyingChanged=false;
+    settling.clear();
+    events.reset(0);
+}
+
+void DroneFleet::anchor(int i,double t) {
+    power[i]=powerAt(i,t);
+    height[i]=heightAt(i,t);
+    anchorTime[i]=t;
+}
+
+void DroneFleet::schedule(int i) {
+    const double t=anchorTime[i];
+    const double low=t+(power[i]-lowPower)/powerConsumption;
+    switch (status[i]) {
+        case landed:
+            events.cancel(i);
+            break;
+        case landing:
+            events.schedule(i,t+height[i]/takeoffSpeed,DroneEventQueue::landingDone);
+            break;
+        case takeoff: {
+            const double done=t+(hoveringHeight-height[i])/takeoffSpeed;
+            if (low<=done) {
+                events.schedule(i,low,DroneEventQueue::lowBattery);
+            } else {
+                events.schedule(i,done,DroneEventQueue::takeoffDone);
+            }
+            break;
+        }
+        default:
+            events.schedule(i,low,DroneEventQueue::lowBattery);
+    }
+}
+
+void DroneFleet::enterFlight(int i) {
+    flyingSet.append(i);
+    flyingChanged=true;
+}
+
+void DroneFleet::leaveFlight(int i) {
+    vX[i]=vY[i]=0;
+    fcX[i]=fcY[i]=0;
+    speed[i]=0;
+    collision[i]=0;
+    settling.append(i);
+    flyingChanged=true;
+}
+
+void DroneFleet::activate(int i) {
+    if (status[i]!=landed) return;
+    anchor(i,time);
+    active.append(i);
+}
+
+void DroneFleet::start(int i) {
+    if (status[i]==landed) {
+        activate(i);
+    } else {
+        anchor(i,time);
+        if (status[i]>=hovering) leaveFlight(i);
+    }
+    status[i]=takeoff;
+    height[i]=0;
+    schedule(i);
+}
+
+void DroneFleet::stop(int i) {
+    if (status[i]==landed || status[i]==landing) return;
+    anchor(i,time);
+    if (status[i]>=hovering) leaveFlight(i);
+    status[i]=landing;
+    schedule(i);
+}
+
+void DroneFleet::processEvents() {
+    DroneEventQueue::Event e;
+    while (events.pop(time,e)) {
+        const int i=e.drone;
+        anchor(i,e.time);
+        switch (e.type) {
+            case DroneEventQueue::takeoffDone:
+                status[i]=hovering;
+                enterFlight(i);
+                break;
+            case DroneEventQueue::lowBattery:
+                if (status[i]>=hovering) leaveFlight(i);
+                status[i]=landing;
+                break;
+            case DroneEventQueue::landingDone:
+                status[i]=landed;
+                height[i]=0;
+                collision[i]=0;
+                grid.remove(i);
+                activeChanged=true;
+                landings.append(i);
+                break;
+        }
+        schedule(i);
+    }
+}
+
+void DroneFleet::updateFlyingBlocks() {
+    // remove the drones which left the flight and the duplicates
+    int kept=0;
+    for (int i:flyingSet) {
+        if (status[i]>=hovering) flyingSet[kept++]=i;
+    }
+    flyingSet.resize(kept);
+    std::sort(flyingSet.begin(),flyingSet.end());
+    flyingSet.erase(std::unique(flyingSet.begin(),flyingSet.end()),flyingSet.end());
+    flyingCount=flyingSet.size();
+
+    flyingBlocks.clear();
+    for (int i:flyingSet) {
+        const int first=i-i%FlightBlock::size;
+        if (flyingBlocks.isEmpty() || flyingBlocks.last()!=first) {
+            flyingBlocks.append(first);
+        }
+    }
+    flyingChanged=false;
+}
+
+void DroneFleet::reserve(int n) {
+    names.reserve(n);
+    status.reserve(n);
+    posX.reserve(n);
+    posY.reserve(n);
+    prevX.reserve(n);
+    prevY.reserve(n);
+    goalX.reserve(n);
+    goalY.reserve(n);
+    vX.reserve(n);
+    vY.reserve(n);
+    fcX.reserve(n);
+    fcY.reserve(n);
+    height.reserve(n);
+    speed.reserve(n);
+    speedSetpoint.reserve(n);
+    power.reserve(n);
+    anchorTime.reserve(n);
+    azimut.reserve(n);
+    collision.reserve(n);
+}
+
+int DroneFleet::collide(int i,float threshold) {
+    const Vector2D A(prevX[i],prevY[i]);
+    Vector2D F(0,0);
+    int pairs=0;
+    collision[i]=0;
+    // collision detection with the drones of the neighboring cells
+    grid.forEachNeighbor(A.x,A.y,[&](int j) {
+        if (j!=i) {
+            Vector2D AB=Vector2D(prevX[j],prevY[j])-A;
+            double l=AB.length();
+            if (l<threshold) {
+                F+=(-coefCollision/threshold)*AB;
+                collision[i]=1;
+            }
+            pairs++;
+        }
+    });
+    fcX[i]=F.x;
+    fcY[i]=F.y;
+    return pairs;
+}
+
+void DroneFleet::update(int i,double dt) {
+    // status>=hovering: takeoff, landing and battery are handled by the events
+    Vector2D position(prevX[i],prevY[i]);
+    Vector2D V(vX[i],vY[i]);
+    Vector2D toGoal=Vector2D(goalX[i],goalY[i])-position;
+    double distance = toGoal.length();
+
+    double damp= 1-dt*(1-damping);
+    V = damp*V+((maxPower*dt/distance)*toGoal)+dt*Vector2D(fcX[i],fcY[i]);
+    position += dt*V;
+    speed[i]=V.length();
+    Vector2D Vn = (1.0/speed[i])*V;
+    if (Vn.y==0) {
+        if (Vn.x>0) {
+            azimut[i] = -90;
+        } else {
+            azimut[i] = 90.0;
+        }
+    } else if (Vn.y>0) {
+        azimut[i] = 180.0-180.0*atan(Vn.x/Vn.y)/M_PI;
+    } else {
+        azimut[i] = -180.0*atan(Vn.x/Vn.y)/M_PI;
+    }
+    if (toGoal.length()<1.0 && speed[i]<10) {
+        V.set(0,0);
+        speed[i]=0;
+        status[i]=landing;
+    }
+    posX[i]=position.x;
+    posY[i]=position.y;
+    vX[i]=V.x;
+    vY[i]=V.y;
+}
+
+void DroneFleet::flyBlock(int first,double dt,unsigned mask) {
+    FlightBlock b;
+    b.prevX=prevX.constData()+first;
+    b.prevY=prevY.constData()+first;
+    b.goalX=goalX.constData()+first;
+    b.goalY=goalY.constData()+first;
+    b.fcX=fcX.constData()+first;
+    b.fcY=fcY.constData()+first;
+    b.vX=vX.data()+first;
+    b.vY=vY.data()+first;
+    b.posX=posX.data()+first;
+    b.posY=posY.data()+first;
+    const unsigned arrived=kernel(b,float(dt),mask);
+
+    for (int l=0; l<FlightBlock::size; l++) {
+        if (!(mask&(1u<<l))) continue;
+        const int i=first+l;
+        speed[i]=b.speed[l];
+        azimut[i]=b.azimut[l];
+        if (arrived&(1u<<l)) {
+            vX[i]=vY[i]=0;
+            speed[i]=0;
+            status[i]=landing;
+        }
+    }
+}
+
+void DroneFleet::step(double dt,float collisionDistance) {
+    ScopedTimer stepTimer(Profiler::simulationStep);
+    const int n=size();
+    // the current positions become the previous state
+    // (both buffers hold the same position for the drones which are not flying)
+    posX.swap(prevX);
+    posY.swap(prevY);
+
+    // status changes due at the beginning of the step
+    landings.clear();
+    {
+        ScopedTimer timer(Profiler::events);
+        processEvents();
+    }
+    for (int i:settling) {
+        posX[i]=prevX[i];
+        posY[i]=prevY[i];
+    }
+    settling.clear();
+    if (activeChanged) {
+        // the landed drones leave the active set
+        int kept=0;
+        for (int i:active) {
+            if (status[i]!=landed) active[kept++]=i;
+        }
+        active.resize(kept);
+        activeChanged=false;
+    }
+    if (flyingChanged) {
+        updateFlyingBlocks();
+    }
+
+    // broad phase: move the drones out of the ground in the grid
+    {
+        ScopedTimer timer(Profiler::collisionBroad);
+        grid.setCellSize(collisionDistance);
+        for (int i:active) {
+            grid.update(i,prevX[i],prevY[i]);
+        }
+    }
+
+    // each drone only writes its own state: they can be advanced in any order
+    std::atomic<int> pairs{0};
+    pool.parallelFor(flyingBlocks.size(),grain/FlightBlock::size,[&](int begin,int end) {
+        int localPairs=0;
+        {
+            // narrow phase of the whole task, then its motion
+            ScopedTimer timer(Profiler::collisionNarrow);
+            for (int k=begin; k<end; k++) {
+                const int first=flyingBlocks[k];
+                const int last=qMin(first+FlightBlock::size,n);
+                for (int i=first; i<last; i++) {
+                    if (status[i]>=hovering) localPairs+=collide(i,collisionDistance);
+                }
+            }
+        }
+        ScopedTimer timer(Profiler::integration);
+        for (int k=begin; k<end; k++) {
+            const int first=flyingBlocks[k];
+            const int last=qMin(first+FlightBlock::size,n);
+            const bool fullBlock=(kernel && last-first==FlightBlock::size);
+            unsigned mask=0;
+            for (int i=first; i<last; i++) {
+                if (status[i]<hovering) continue;
+                if (fullBlock) {
+                    mask|=1u<<(i-first);
+                } else {
+                    update(i,dt);
+                }
+            }
+            if (mask) {
+                flyBlock(first,dt,mask);
+            }
+        }
+        pairs+=localPairs;
+    });
+    collisionPairs=pairs;
+    time+=dt;
+
+    // the drones arrived during this step start landing
+    for (int i:flyingSet) {
+        if (status[i]!=landing) continue;
+        power[i]=powerAt(i,time);
+        height[i]=hoveringHeight;
+        anchorTime[i]=time;
+        schedule(i);
+        leaveFlight(i);
+    }
+}
+
+void DroneFleet::setKernel(DroneKernel::Isa p_isa) {
+    kernel=DroneKernel::get(p_isa);
+    isa=kernel?p_isa:DroneKernel::scalar;
+}
+
+DroneFleet::KernelAccuracy DroneFleet::checkKernelAccuracy(DroneKernel::Isa isa,int n) {
+    DroneFleet ref,vec;
+    ref.setKernel(DroneKernel::scalar);
+    ref.setThreadCount(1);
+    vec.setKernel(isa);
+    vec.setThreadCount(1);
+
+    // random flying drones, some of them close to their goal or to each other
+    std::mt19937 gen(12345);
+    std::uniform_real_distribution<float> pos(0,2000),vel(-50,50),near(-2,2);
+    for (DroneFleet *f:{&ref,&vec}) f->reserve(n);
+    for (int i=0; i<n; i++) {
+        const Vector2D p(pos(gen),pos(gen));
+        const Vector2D g=(i%5==0)?p+Vector2D(near(gen),near(gen)):Vector2D(pos(gen),pos(gen));
+        const float vx=(i%5==0)?near(gen):vel(gen),vy=(i%7==0)?0.0f:vel(gen);
+        const double pw=(i%11==0)?20+powerConsumption/takeoffSpeed:maxPower/2.0;
+        for (DroneFleet *f:{&ref,&vec}) {
+            f->add("",p);
+            f->setGoalPosition(i,g);
+            f->activate(i);
+            f->status[i]=flying;
+            f->height[i]=hoveringHeight;
+            f->vX[i]=vx;
+            f->vY[i]=vy;
+            f->power[i]=pw;
+            f->schedule(i);
+            f->enterFlight(i);
+        }
+    }
+    ref.step(0.02,96);
+    vec.step(0.02,96);
+
+    KernelAccuracy acc;
+    for (int i=0; i<n; i++) {
+        acc.position=qMax(acc.position,(ref.getPosition(i)-vec.getPosition(i)).length());
+        acc.speed=qMax(acc.speed,std::abs(ref.speed[i]-vec.speed[i]));
+        if (ref.speed[i]!=0) {
+            double d=std::fmod(std::abs(ref.azimut[i]-vec.azimut[i]),360.0);
+            acc.azimut=qMax(acc.azimut,qMin(d,360.0-d));
+        }
+        if (ref.status[i]!=vec.status[i]) acc.statusMismatches++;
+    }
+    return acc;
+}
@@ -0,0 +1,315 @@
+/**
+ * @file dronefleet.h
+ * @brief Headless simulation engine storing the state of all the drones as contiguous arrays.
+ */
+#ifndef DRONEFLEET_H
+#define DRONEFLEET_H
+
+#include <QVector>
+#include <QString>
+#include "vector2d.h"
+#include "spatialgrid.h"
+#include "workerpool.h"
+#include "dronekernel.h"
+#include "droneevents.h"
+
+/**
+ * @brief Physical parameters and status values shared by the fleet engine and the drone views
+ */
+struct DroneModel {
+    static constexpr double maxSpeed=50; ///< max speed in pixels per second
+    static constexpr double maxPower=200; ///< max power of drone motors
+    static constexpr double takeoffSpeed=2.5; ///< unit/s
+    static constexpr double hoveringHeight=5; ///< units
+    static constexpr double coefCollision=1000; ///< coefficient for collision avoidment
+    static constexpr double damping=0.2;        ///< damping for motion simulation
+    static constexpr double chargingSpeed=10;   ///< speed of charging (power/s)
+    static constexpr double powerConsumption=5; ///< speed of consumption (power/s)
+    enum droneStatus { landed,takeoff,landing,hovering,turning,flying};
+};
+
+/**
+ * @class DroneFleet
+ * @brief The DroneFleet class simulates a set of drones without any Qt widget.
+ *
+ * Each physical quantity of the drones is stored in its own array (struct of arrays),
+ * a drone being identified by its index in these arrays. The motion model is the one of
+ * the original Drone::update(): takeoff, hovering/flying toward a goal with collision
+ * avoidance, landing and charging on the ground.
+ *
+ * The positions are double buffered: during a step, every drone reads the positions of the
+ * others in the previous-state buffer and writes its own in the next-state buffer. The drones
+ * are then independent and are advanced in parallel, with a result that does not depend on
+ * the number of threads nor on the order of the drones.
+ *
+ * Only the flying drones are advanced by a step. The power and the height of the other drones
+ * evolve linearly: they are stored at an anchor time and computed in closed form when they are
+ * queried. The status changes of these drones (end of the takeoff, low battery, end of the
+ * landing) are predicted from the anchored values and stored in an event queue, whose due
+ * events are processed at the beginning of each step. The cost of a step then only depends on
+ * the number of flying drones and of status changes.
+ *
+ * When the processor supports it, the flying drones are advanced 8 at a time by a vectorized
+ * flight kernel (see DroneKernel), the other drones by the scalar code.
+ */
+class DroneFleet : public DroneModel {
+public:
+    DroneFleet() {}
+
+    /**
+     * @brief Add a new landed drone to the fleet
+     * @param name name of the drone
+     * @param pos initial position of the drone
+     * @return the index of the new drone
+     */
+    int add(const QString &name,const Vector2D &pos);
+    /**
+     * @brief Remove all the drones
+     */
+    void clear();
+    /**
+     * @brief Prepare the arrays to receive n drones
+     * @param n expected number of drones
+     */
+    void reserve(int n);
+    /**
+     * @brief size get the number of drones of the fleet
+     * @return the number of drones
+     */
+    inline int size() const { return names.size(); }
+
+    /**
+     * @brief Make the drone i takeoff to move to its goal position
+     */
+    void start(int i);
+    /**
+     * @brief Ask the drone i for landing
+     */
+    void stop(int i);
+    /**
+     * @brief set the speed of fly of the drone i
+     * @param s: speed
+     */
+    inline void setSpeed(int i,double s) { speedSetpoint[i]=(s>maxSpeed?maxSpeed:s); }
+    /**
+     * @brief set the initial position of the drone i (only if it is landed)
+     */
+    inline void setInitialPosition(int i,const Vector2D& pos) {
+        if (status[i]==landed) { posX[i]=prevX[i]=pos.x; posY[i]=prevY[i]=pos.y; groundRevision++; }
+    }
+    /**
+     * @brief set the goal position of the drone i (landing place)
+     */
+    inline void setGoalPosition(int i,const Vector2D& pos) { goalX[i]=pos.x; goalY[i]=pos.y; }
+
+    inline const QString &getName(int i) const { return names[i]; }
+    inline Vector2D getPosition(int i) const { return Vector2D(posX[i],posY[i]); }
+    /**
+     * @brief get the position of the drone i between the two last steps
+     * @param alpha 0 for the position before the last step, 1 for the current position
+     */
+    inline Vector2D getInterpolatedPosition(int i,double alpha) const {
+        return Vector2D(prevX[i]+alpha*(posX[i]-prevX[i]),prevY[i]+alpha*(posY[i]-prevY[i]));
+    }
+    inline Vector2D getGoalPosition(int i) const { return Vector2D(goalX[i],goalY[i]); }
+    inline droneStatus getStatus(int i) const { return droneStatus(status[i]); }
+    /**
+     * @brief get the current height of the drone i
+     */
+    inline double getHeight(int i) const { return heightAt(i,time); }
+    inline double getSpeed(int i) const { return speed[i]; }
+    inline double getAzimut(int i) const { return azimut[i]; }
+    /**
+     * @brief get the raw power of the drone i (between 0 and maxPower)
+     */
+    inline double getRawPower(int i) const { return powerAt(i,time); }
+    /**
+     * @brief get the Power rank of the drone i between 0 and 100
+     */
+    inline double getPower(int i) const { return 100.0*getRawPower(i)/maxPower; }
+    inline bool hasCollision(int i) const { return collision[i]!=0; }
+    /**
+     * @brief Get the simulated time (s), sum of the durations of the steps
+     */
+    inline double getTime() const { return time; }
+    /**
+     * @brief Get the number of drones out of the ground
+     */
+    inline int getActiveCount() const { return active.size(); }
+    /**
+     * @brief Get the indices of the drones out of the ground, unsorted
+     */
+    inline const QVector<int> &getActiveDrones() const { return active; }
+    /**
+     * @brief Get the indices of the drones which landed during the last step
+     */
+    inline const QVector<int> &getLandings() const { return landings; }
+    /**
+     * @brief Get the number of changes of the drones on the ground made outside of the steps
+     * (moves of landed drones): the other landed drones only change by charging
+     */
+    inline quint64 getGroundRevision() const { return groundRevision; }
+    /**
+     * @brief Get the number of drones moving horizontally, advanced at each step
+     */
+    inline int getFlyingCount() const { return flyingCount; }
+    /**
+     * @brief Get the number of status changes waiting in the event queue
+     */
+    inline int getPendingEventCount() const { return events.size(); }
+
+    /**
+     * @brief Change the number of threads used to advance the fleet
+     * @param n number of threads, 0 to use the number of cores
+     */
+    inline void setThreadCount(int n) { pool.setThreadCount(n); }
+    inline int getThreadCount() const { return pool.getThreadCount(); }
+    /**
+     * @brief Get the threads advancing the fleet, idle between the steps and shared with the other parallel loops
+     */
+    inline WorkerPool &getPool() { return pool; }
+
+    /**
+     * @brief Choose the instruction set of the flight kernel
+     * @param p_isa the instruction set, replaced by the scalar code if it is not supported
+     */
+    void setKernel(DroneKernel::Isa p_isa);
+    inline DroneKernel::Isa getKernel() const { return isa; }
+
+    /**
+     * @brief Maximum differences between a flight kernel and the scalar code
+     */
+    struct KernelAccuracy {
+        double position=0; ///< max error on the positions
+        double speed=0;    ///< max error on the speeds
+        double azimut=0;   ///< max error on the azimuts (degree)
+        int statusMismatches=0; ///< number of drones whose status differs
+    };
+    /**
+     * @brief Compare one step of a flight kernel with the scalar code on random flying drones
+     * @param isa instruction set of the tested kernel
+     * @param n number of drones
+     * @return the maximum differences
+     */
+    static KernelAccuracy checkKernelAccuracy(DroneKernel::Isa isa,int n=4096);
+
+    /**
+     * @brief Advance the whole fleet of one sub-step: collision detection then motion
+     * @param dt duration of the sub-step (s)
+     * @param collisionDistance distance of collision detection between two drones
+     */
+    void step(double dt,float collisionDistance);
+    /**
+     * @brief Get the number of pairs of drones tested by the last collision detection
+     * @return the number of tested pairs
+     */
+    inline int getCollisionPairCount() const { return collisionPairs; }
+    /**
+     * @brief Get the broad phase grid of the drones out of the ground
+     */
+    inline const SpatialGrid &getGrid() const { return grid; }
+
+private:
+    /**
+     * @brief Power of the drone i at time t, from its anchored power
+     */
+    inline double powerAt(int i,double t) const {
+        const double elapsed=t-anchorTime[i];
+        if (status[i]!=landed) return power[i]-elapsed*powerConsumption;
+        // charging since the landing
+        const double p=power[i]+elapsed*chargingSpeed;
+        return p>maxPower?maxPower:p;
+    }
+    /**
+     * @brief Height of the drone i at time t, from its anchored height
+     */
+    inline double heightAt(int i,double t) const {
+        const double elapsed=t-anchorTime[i];
+        switch (status[i]) {
+            case takeoff: return qMin(hoveringHeight,height[i]+elapsed*takeoffSpeed);
+            case landing: return qMax(0.0,height[i]-elapsed*takeoffSpeed);
+            default: return height[i];
+        }
+    }
+    /**
+     * @brief Store the power and the height of the drone i at time t, before a change of status
+     */
+    void anchor(int i,double t);
+    /**
+     * @brief Predict the next status change of the drone i from its anchored values
+     */
+    void schedule(int i);
+    /**
+     * @brief Apply the status changes due at the current time
+     */
+    void processEvents();
+    /**
+     * @brief Add the drone i, which starts to move horizontally, to the flying drones
+     */
+    void enterFlight(int i);
+    /**
+     * @brief Stop the horizontal motion of the drone i
+     *
+     * Its position is copied in both buffers at the beginning of the next step.
+     */
+    void leaveFlight(int i);
+    /**
+     * @brief Compute the collision force of the drone i from the previous positions
+     * @param threshold distance of collision detection
+     * @return the number of tested pairs
+     */
+    int collide(int i,float threshold);
+    /**
+     * @brief Advance the drone i of dt seconds, from the previous position to the next one
+     */
+    void update(int i,double dt);
+    /**
+     * @brief Advance the flying drones of the block starting at index first with the flight kernel
+     * @param mask bit mask of the flying drones of the block
+     */
+    void flyBlock(int first,double dt,unsigned mask);
+    /**
+     * @brief Put the landed drone i back in the active set, with its current power
+     */
+    void activate(int i);
+    /**
+     * @brief Sort the flying drones and list the blocks of 8 drones containing flying drones
+     */
+    void updateFlyingBlocks();
+
+    static constexpr int grain=1024; ///< number of drones of a parallel task
+    static constexpr double lowPower=20+powerConsumption/takeoffSpeed; ///< power triggering the landing
+
+    QVector<QString> names;       ///< name of each drone
+    QVector<quint8> status;       ///< status of each drone (droneStatus)
+    QVector<float> posX,posY;     ///< current positions (next-state buffer during a step)
+    QVector<float> prevX,prevY;   ///< positions at the beginning of the step (previous-state buffer)
+    QVector<float> goalX,goalY;   ///< goal positions
+    QVector<float> vX,vY;         ///< current speed vectors
+    QVector<float> fcX,fcY;       ///< forces generated by the collision detection
+    QVector<double> height;       ///< heights at the anchor time
+    QVector<double> speed;        ///< current speeds
+    QVector<double> speedSetpoint;///< speeds to reach if possible
+    QVector<double> power;        ///< powers at the anchor time
+    QVector<double> anchorTime;   ///< time of the last status change
+    QVector<double> azimut;       ///< rotation angles of the drones
+    QVector<quint8> collision;    ///< 1 if a collision is detected
+    SpatialGrid grid;             ///< broad phase of the collision detection
+    int collisionPairs=0;         ///< number of pairs tested during the last step
+    double time=0;                ///< simulated time
+    QVector<int> active;          ///< indices of the drones out of the ground
+    bool activeChanged=false;     ///< true if landed drones must be removed from active
+    QVector<int> landings;        ///< drones which landed during the last step
+    quint64 groundRevision=0;     ///< number of moves of landed drones
+    QVector<int> flyingSet;       ///< indices of the flying drones (may contain drones which left the flight)
+    QVector<int> flyingBlocks;    ///< first index of the blocks of 8 drones containing flying drones
+    int flyingCount=0;            ///< number of flying drones
+    bool flyingChanged=false;     ///< true if flyingSet must be cleaned and flyingBlocks rebuilt
+    QVector<int> settling;        ///< drones which left the flight since the last step
+    DroneEventQueue events;       ///< predicted status changes
+    WorkerPool pool;              ///< threads advancing the drones
+    DroneKernel::Isa isa=DroneKernel::detect();        ///< instruction set of the flight kernel
+    DroneKernel::FlightKernel kernel=DroneKernel::get(isa); ///< flight kernel, nullptr for the scalar code
+};
+
+#endif // DRONEFLEET_H
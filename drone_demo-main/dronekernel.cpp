@@ -0,0 +1,167 @@
+#include "dronekernel.h"
+#include "dronefleet.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DRONEKERNEL_X86
+#include <immintrin.h>
+#endif
+
+#ifdef DRONEKERNEL_X86
+
+// coefficients of the approximation of atan on [0,1] (Abramowitz & Stegun 4.4.49)
+static const float atanC3=-0.3302995f;
+static const float atanC5=0.1801410f;
+static const float atanC7=-0.0851330f;
+static const float atanC9=0.0208351f;
+static const float radToDeg=float(180.0/M_PI);
+
+//-------------------------------------
+// SSE4.1: the block is processed as two groups of 4 lanes
+
+__attribute__((target("sse4.1")))
+static __m128 atan2DegSse(__m128 y,__m128 x) {
+    const __m128 signMask=_mm_set1_ps(-0.0f);
+    const __m128 ay=_mm_andnot_ps(signMask,y);
+    const __m128 ax=_mm_andnot_ps(signMask,x);
+    const __m128 a=_mm_div_ps(_mm_min_ps(ax,ay),_mm_max_ps(ax,ay));
+    const __m128 s=_mm_mul_ps(a,a);
+    __m128 r=_mm_add_ps(_mm_mul_ps(_mm_set1_ps(atanC9),s),_mm_set1_ps(atanC7));
+    r=_mm_add_ps(_mm_mul_ps(r,s),_mm_set1_ps(atanC5));
+    r=_mm_add_ps(_mm_mul_ps(r,s),_mm_set1_ps(atanC3));
+    r=_mm_add_ps(_mm_mul_ps(_mm_mul_ps(r,s),a),a);
+    r=_mm_blendv_ps(r,_mm_sub_ps(_mm_set1_ps(float(M_PI/2)),r),_mm_cmpgt_ps(ay,ax));
+    r=_mm_blendv_ps(r,_mm_sub_ps(_mm_set1_ps(float(M_PI)),r),_mm_cmplt_ps(x,_mm_setzero_ps()));
+    r=_mm_or_ps(r,_mm_and_ps(signMask,y));
+    return _mm_mul_ps(r,_mm_set1_ps(radToDeg));
+}
+
+__attribute__((target("sse4.1")))
+static unsigned fly4Sse(FlightBlock &b,int o,float dt,unsigned mask) {
+    const __m128i bits=_mm_setr_epi32(1,2,4,8);
+    const __m128 m=_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(int(mask)),bits),bits));
+    const __m128 vdt=_mm_set1_ps(dt);
+    const __m128 damp=_mm_set1_ps(float(1-dt*(1-DroneModel::damping)));
+    const __m128 power=_mm_set1_ps(float(DroneModel::maxPower*dt));
+
+    const __m128 px=_mm_loadu_ps(b.prevX+o),py=_mm_loadu_ps(b.prevY+o);
+    const __m128 tx=_mm_sub_ps(_mm_loadu_ps(b.goalX+o),px);
+    const __m128 ty=_mm_sub_ps(_mm_loadu_ps(b.goalY+o),py);
+    const __m128 distance=_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(tx,tx),_mm_mul_ps(ty,ty)));
+    const __m128 k=_mm_div_ps(power,distance);
+    const __m128 oldVx=_mm_loadu_ps(b.vX+o),oldVy=_mm_loadu_ps(b.vY+o);
+    const __m128 vx=_mm_add_ps(_mm_add_ps(_mm_mul_ps(damp,oldVx),_mm_mul_ps(k,tx)),_mm_mul_ps(vdt,_mm_loadu_ps(b.fcX+o)));
+    const __m128 vy=_mm_add_ps(_mm_add_ps(_mm_mul_ps(damp,oldVy),_mm_mul_ps(k,ty)),_mm_mul_ps(vdt,_mm_loadu_ps(b.fcY+o)));
+    const __m128 speed=_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx,vx),_mm_mul_ps(vy,vy)));
+
+    // azimut relatively to the y direction, in ]-90,270] as the scalar code
+    __m128 az=atan2DegSse(vx,_mm_sub_ps(_mm_setzero_ps(),vy));
+    az=_mm_blendv_ps(az,_mm_add_ps(az,_mm_set1_ps(360.0f)),_mm_cmplt_ps(az,_mm_set1_ps(-90.0f)));
+    const __m128 vertical=_mm_blendv_ps(_mm_set1_ps(90.0f),_mm_set1_ps(-90.0f),_mm_cmpgt_ps(vx,_mm_setzero_ps()));
+    az=_mm_blendv_ps(az,vertical,_mm_cmpeq_ps(vy,_mm_setzero_ps()));
+
+    _mm_storeu_ps(b.vX+o,_mm_blendv_ps(oldVx,vx,m));
+    _mm_storeu_ps(b.vY+o,_mm_blendv_ps(oldVy,vy,m));
+    _mm_storeu_ps(b.posX+o,_mm_blendv_ps(px,_mm_add_ps(px,_mm_mul_ps(vdt,vx)),m));
+    _mm_storeu_ps(b.posY+o,_mm_blendv_ps(py,_mm_add_ps(py,_mm_mul_ps(vdt,vy)),m));
+    _mm_storeu_ps(b.speed+o,speed);
+    _mm_storeu_ps(b.azimut+o,az);
+
+    const __m128 arrived=_mm_and_ps(_mm_and_ps(_mm_cmplt_ps(distance,_mm_set1_ps(1.0f)),
+                                               _mm_cmplt_ps(speed,_mm_set1_ps(10.0f))),m);
+    return unsigned(_mm_movemask_ps(arrived));
+}
+
+__attribute__((target("sse4.1")))
+static unsigned flySse4(FlightBlock &b,float dt,unsigned mask) {
+    unsigned arrived=0;
+    if (mask&0x0F) arrived|=fly4Sse(b,0,dt,mask&0x0F);
+    if (mask&0xF0) arrived|=fly4Sse(b,4,dt,mask>>4)<<4;
+    return arrived;
+}
+
+//-------------------------------------
+// AVX2: the 8 lanes at once
+
+__attribute__((target("avx2")))
+static __m256 atan2DegAvx(__m256 y,__m256 x) {
+    const __m256 signMask=_mm256_set1_ps(-0.0f);
+    const __m256 ay=_mm256_andnot_ps(signMask,y);
+    const __m256 ax=_mm256_andnot_ps(signMask,x);
+    const __m256 a=_mm256_div_ps(_mm256_min_ps(ax,ay),_mm256_max_ps(ax,ay));
+    const __m256 s=_mm256_mul_ps(a,a);
+    __m256 r=_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(atanC9),s),_mm256_set1_ps(atanC7));
+    r=_mm256_add_ps(_mm256_mul_ps(r,s),_mm256_set1_ps(atanC5));
+    r=_mm256_add_ps(_mm256_mul_ps(r,s),_mm256_set1_ps(atanC3));
+    r=_mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(r,s),a),a);
+    r=_mm256_blendv_ps(r,_mm256_sub_ps(_mm256_set1_ps(float(M_PI/2)),r),_mm256_cmp_ps(ay,ax,_CMP_GT_OQ));
+    r=_mm256_blendv_ps(r,_mm256_sub_ps(_mm256_set1_ps(float(M_PI)),r),_mm256_cmp_ps(x,_mm256_setzero_ps(),_CMP_LT_OQ));
+    r=_mm256_or_ps(r,_mm256_and_ps(signMask,y));
+    return _mm256_mul_ps(r,_mm256_set1_ps(radToDeg));
+}
+
+__attribute__((target("avx2")))
+static unsigned flyAvx2(FlightBlock &b,float dt,unsigned mask) {
+    const __m256i bits=_mm256_setr_epi32(1,2,4,8,16,32,64,128);
+    const __m256 m=_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(int(mask)),bits),bits));
+    const __m256 vdt=_mm256_set1_ps(dt);
+    const __m256 damp=_mm256_set1_ps(float(1-dt*(1-DroneModel::damping)));
+    const __m256 power=_mm256_set1_ps(float(DroneModel::maxPower*dt));
+    const __m256 zero=_mm256_setzero_ps();
+
+    const __m256 px=_mm256_loadu_ps(b.prevX),py=_mm256_loadu_ps(b.prevY);
+    const __m256 tx=_mm256_sub_ps(_mm256_loadu_ps(b.goalX),px);
+    const __m256 ty=_mm256_sub_ps(_mm256_loadu_ps(b.goalY),py);
+    const __m256 distance=_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(tx,tx),_mm256_mul_ps(ty,ty)));
+    const __m256 k=_mm256_div_ps(power,distance);
+    const __m256 oldVx=_mm256_loadu_ps(b.vX),oldVy=_mm256_loadu_ps(b.vY);
+    const __m256 vx=_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(damp,oldVx),_mm256_mul_ps(k,tx)),_mm256_mul_ps(vdt,_mm256_loadu_ps(b.fcX)));
+    const __m256 vy=_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(damp,oldVy),_mm256_mul_ps(k,ty)),_mm256_mul_ps(vdt,_mm256_loadu_ps(b.fcY)));
+    const __m256 speed=_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx,vx),_mm256_mul_ps(vy,vy)));
+
+    // azimut relatively to the y direction, in ]-90,270] as the scalar code
+    __m256 az=atan2DegAvx(vx,_mm256_sub_ps(zero,vy));
+    az=_mm256_blendv_ps(az,_mm256_add_ps(az,_mm256_set1_ps(360.0f)),_mm256_cmp_ps(az,_mm256_set1_ps(-90.0f),_CMP_LT_OQ));
+    const __m256 vertical=_mm256_blendv_ps(_mm256_set1_ps(90.0f),_mm256_set1_ps(-90.0f),_mm256_cmp_ps(vx,zero,_CMP_GT_OQ));
+    az=_mm256_blendv_ps(az,vertical,_mm256_cmp_ps(vy,zero,_CMP_EQ_OQ));
+
+    _mm256_storeu_ps(b.vX,_mm256_blendv_ps(oldVx,vx,m));
+    _mm256_storeu_ps(b.vY,_mm256_blendv_ps(oldVy,vy,m));
+    _mm256_storeu_ps(b.posX,_mm256_blendv_ps(px,_mm256_add_ps(px,_mm256_mul_ps(vdt,vx)),m));
+    _mm256_storeu_ps(b.posY,_mm256_blendv_ps(py,_mm256_add_ps(py,_mm256_mul_ps(vdt,vy)),m));
+    _mm256_storeu_ps(b.speed,speed);
+    _mm256_storeu_ps(b.azimut,az);
+
+    const __m256 arrived=_mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(distance,_mm256_set1_ps(1.0f),_CMP_LT_OQ),
+                                                     _mm256_cmp_ps(speed,_mm256_set1_ps(10.0f),_CMP_LT_OQ)),m);
+    return unsigned(_mm256_movemask_ps(arrived));
+}
+
+#endif // DRONEKERNEL_X86
+
+DroneKernel::Isa DroneKernel::detect() {
+#ifdef DRONEKERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return avx2;
+    if (__builtin_cpu_supports("sse4.1")) return sse4;
+#endif
+    return scalar;
+}
+
+DroneKernel::FlightKernel DroneKernel::get(Isa isa) {
+#ifdef DRONEKERNEL_X86
+    const Isa best=detect();
+    if (isa==avx2 && best>=avx2) return flyAvx2;
+    if (isa==sse4 && best>=sse4) return flySse4;
+#else
+    Q_UNUSED(isa);
+#endif
+    return nullptr;
+}
+
+const char *DroneKernel::name(Isa isa) {
+    switch (isa) {
+        case sse4: return "SSE4.1";
+        case avx2: return "AVX2";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file dronekernel.h
+ * @brief Vectorized computation of the motion of 8 flying drones at once.
+ */
+#ifndef DRONEKERNEL_H
+#define DRONEKERNEL_H
+
+/**
+ * @brief Data of a block of 8 consecutive drones of the fleet, read and written by a flight kernel
+ */
+struct FlightBlock {
+    static constexpr int size=8; ///< number of drones of a block
+
+    const float *prevX,*prevY;   ///< positions at the beginning of the step
+    const float *goalX,*goalY;   ///< goal positions
+    const float *fcX,*fcY;       ///< collision forces
+    float *vX,*vY;               ///< speed vectors (read and written)
+    float *posX,*posY;           ///< next positions (written)
+    float speed[size];           ///< norms of the new speed vectors (written)
+    float azimut[size];          ///< new azimuts in degree (written)
+};
+
+/**
+ * @brief Flight kernels: vectorized versions of the hovering/flying branch of the drone update
+ *
+ * A kernel advances the lanes of a block selected by a bit mask, the other lanes of vX, vY,
+ * posX and posY are not modified. It returns the mask of the lanes which reached their goal
+ * (distance to the goal under 1 and speed under 10). The azimut is computed by a polynomial
+ * approximation of atan2 (error under 1e-5 rad) folded in the range of the scalar code.
+ */
+namespace DroneKernel {
+    /**
+     * @brief Instruction sets of the kernels
+     */
+    enum Isa { scalar,sse4,avx2 };
+
+    typedef unsigned (*FlightKernel)(FlightBlock &b,float dt,unsigned mask);
+
+    /**
+     * @brief Get the best instruction set supported by the processor
+     */
+    Isa detect();
+    /**
+     * @brief Get the kernel for an instruction set
+     * @param isa the instruction set
+     * @return the kernel, nullptr for the scalar code or if the processor does not support isa
+     */
+    FlightKernel get(Isa isa);
+    /**
+     * @brief Get the name of an instruction set
+     */
+    const char *name(Isa isa);
+}
+
+#endif // DRONEKERNEL_H
@@ -0,0 +1,35 @@
+#include "dronelistmodel.h"
+
+DroneListModel::DroneListModel(const DroneFleet *p_fleet,QObject *parent)
+    : QAbstractListModel(parent),fleet(p_fleet) {
+    rows=fleet->size();
+}
+
+int DroneListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid()?0:rows;
+}
+
+QVariant DroneListModel::data(const QModelIndex &index,int role) const {
+    if (!index.isValid() || index.row()>=rows) return QVariant();
+    const int i=index.row();
+    switch (role) {
+        case Qt::DisplayRole: return fleet->getName(i);
+        case StatusRole: return int(fleet->getStatus(i));
+        case SpeedRole: return fleet->getSpeed(i);
+        case PowerRole: return fleet->getRawPower(i);
+        case AzimutRole: return fleet->getAzimut(i);
+        case CollisionRole: return fleet->hasCollision(i);
+        default: return QVariant();
+    }
+}
+
+void DroneListModel::reload() {
+    beginResetModel();
+    rows=fleet->size();
+    endResetModel();
+}
+
+void DroneListModel::refresh() {
+    // the views ignore the changes of the rows outside their viewport
+    if (rows>0) emit dataChanged(index(0),index(rows-1));
+}
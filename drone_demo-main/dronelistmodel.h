@@ -0,0 +1,57 @@
+/**
+ * @file dronelistmodel.h
+ * @brief Item model of the list of the drones, read from the fleet engine.
+ */
+#ifndef DRONELISTMODEL_H
+#define DRONELISTMODEL_H
+
+#include <QAbstractListModel>
+#include "dronefleet.h"
+
+/**
+ * @class DroneListModel
+ * @brief The DroneListModel class exposes a row per drone of the fleet to a QListView.
+ *
+ * The model stores nothing: the data are read in the fleet when the view paints a row, so only
+ * the visible rows cost anything. refresh() is called once per display frame and marks all the
+ * rows as changed, the view repainting only the ones in its viewport.
+ */
+class DroneListModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    /**
+     * @brief Roles of the state of a drone, in addition to Qt::DisplayRole (name)
+     */
+    enum DroneRole {
+        StatusRole=Qt::UserRole+1, ///< DroneModel::droneStatus
+        SpeedRole,                 ///< speed (pixels per second)
+        PowerRole,                 ///< power (DroneModel::maxPower when full)
+        AzimutRole,                ///< direction of motion (degree)
+        CollisionRole              ///< true if the drone is too close to another
+    };
+
+    /**
+     * @brief DroneListModel constructor
+     * @param p_fleet fleet engine holding the state of the drones
+     * @param parent owner of the model
+     */
+    explicit DroneListModel(const DroneFleet *p_fleet,QObject *parent=nullptr);
+
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index,int role=Qt::DisplayRole) const override;
+
+    /**
+     * @brief Rebuild the rows after drones were added or removed from the fleet
+     */
+    void reload();
+    /**
+     * @brief Notify the views that the state of the drones changed
+     */
+    void refresh();
+
+private:
+    const DroneFleet *fleet; ///< engine holding the state of the drones
+    int rows=0;              ///< number of rows known by the views
+};
+
+#endif // DRONELISTMODEL_H
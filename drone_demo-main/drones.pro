@@ -8,27 +8,65 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# The debug and info messages (qCDebug, qCInfo) are compiled out of release builds,
+# see logging.h for the categories switched at run time in debug builds.
+CONFIG(release, debug|release): DEFINES += QT_NO_DEBUG_OUTPUT QT_NO_INFO_OUTPUT
+
 SOURCES += \
     canvas.cpp \
+    delaunaytriangulation.cpp \
     determinant.cpp \
+    divideconquerdelaunay.cpp \
     drone.cpp \
+    dronedelegate.cpp \
+    droneevents.cpp \
+    dronefleet.cpp \
+    dronekernel.cpp \
+    dronelistmodel.cpp \
+    logging.cpp \
     main.cpp \
     mainwindow.cpp \
     mypolygon.cpp \
+    predicates.cpp \
+    profiler.cpp \
     server.cpp \
+    simulationclock.cpp \
+    spatialgrid.cpp \
+    spriteatlas.cpp \
+    trajectoryreader.cpp \
+    trajectoryrecorder.cpp \
     triangle.cpp \
     vector2d.cpp \
-    voronoi.cpp
+    viewportindex.cpp \
+    voronoi.cpp \
+    workerpool.cpp
 HEADERS += \
     canvas.h \
+    delaunaytriangulation.h \
     determinant.h \
+    divideconquerdelaunay.h \
     drone.h \
+    dronedelegate.h \
+    droneevents.h \
+    dronefleet.h \
+    dronekernel.h \
+    dronelistmodel.h \
+    logging.h \
     mainwindow.h \
     mypolygon.h \
+    predicates.h \
+    profiler.h \
     server.h \
+    simulationclock.h \
+    spatialgrid.h \
+    spriteatlas.h \
+    trajectoryreader.h \
+    trajectoryrecorder.h \
     triangle.h \
     vector2d.h \
-    voronoi.h
+    viewportindex.h \
+    voronoi.h \
+    workerpool.h
 
 FORMS += \
     mainwindow.ui
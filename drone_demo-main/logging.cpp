@@ -0,0 +1,8 @@
+#include "logging.h"
+
+// the categories of the per-frame and per-triangle paths only log warnings by default
+Q_LOGGING_CATEGORY(lcGeometry,"drones.geometry",QtWarningMsg)
+Q_LOGGING_CATEGORY(lcMesh,"drones.mesh",QtWarningMsg)
+Q_LOGGING_CATEGORY(lcPaint,"drones.paint",QtWarningMsg)
+Q_LOGGING_CATEGORY(lcInput,"drones.input",QtWarningMsg)
+Q_LOGGING_CATEGORY(lcSimulation,"drones.simulation",QtInfoMsg)
@@ -0,0 +1,25 @@
+/**
+ * @file logging.h
+ * @brief Logging categories of the subsystems of the application.
+ *
+ * The messages are written with qCDebug(category) / qCWarning(category). In debug builds,
+ * the debug messages of the hot paths are disabled by default and switched on at run time
+ * with the logging rules, for example:
+ *
+ *     QT_LOGGING_RULES="drones.geometry.debug=true;drones.paint.debug=true"
+ *
+ * In release builds, drones.pro defines QT_NO_DEBUG_OUTPUT and QT_NO_INFO_OUTPUT: the debug and
+ * info messages are compiled out, including the formatting of their arguments.
+ */
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(lcGeometry)   ///< Triangle tests and drawing (drones.geometry)
+Q_DECLARE_LOGGING_CATEGORY(lcMesh)       ///< triangulation, Delaunay flips and Voronoi (drones.mesh)
+Q_DECLARE_LOGGING_CATEGORY(lcPaint)      ///< Canvas drawing (drones.paint)
+Q_DECLARE_LOGGING_CATEGORY(lcInput)      ///< mouse interaction with the canvas (drones.input)
+Q_DECLARE_LOGGING_CATEGORY(lcSimulation) ///< fleet engine (drones.simulation)
+
+#endif // LOGGING_H
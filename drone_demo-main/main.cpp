@@ -1,11 +1,52 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
 
 int main(int argc, char *argv[])
 {
+    // the offscreen rendering needs no display
+    for (int i = 1; i < argc; i++) {
+        if (QByteArray(argv[i]) == "--render" && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+    }
     QApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Drone fleet demo. With --render, runs the simulation without display "
+                                     "and renders the canvas in frames at a fixed frame rate.");
+    parser.addHelpOption();
+    const QCommandLineOption renderOption("render", "Render offscreen the JSON configuration <config>.", "config");
+    const QCommandLineOption ticksOption("ticks", "Number of simulation steps to run (default 500).", "n", "500");
+    const QCommandLineOption fpsOption("fps", "Frames per second of simulated time (default 30).", "fps", "30");
+    const QCommandLineOption sizeOption("size", "Size of the frames (default 1024x768).", "WxH", "1024x768");
+    const QCommandLineOption framesOption("frames", "Write the frames as numbered PNG files in <dir>.", "dir");
+    const QCommandLineOption rawOption("raw", "Write the frames as a raw BGRA stream in <file>.", "file");
+    const QCommandLineOption timingsOption("timings", "Write the timings of the phases as JSON in <file>.", "file");
+    const QCommandLineOption validateOption("validate", "Also check the Delaunay triangulation against every vertex (slow, for debugging).");
+    parser.addOptions({renderOption, ticksOption, fpsOption, sizeOption, framesOption, rawOption, timingsOption, validateOption});
+    parser.process(a);
+
     MainWindow w;
+    w.setFullValidation(parser.isSet(validateOption));
+    if (parser.isSet(renderOption)) {
+        OffscreenOptions options;
+        options.configPath = parser.value(renderOption);
+        options.ticks = parser.value(ticksOption).toInt();
+        options.fps = parser.value(fpsOption).toDouble();
+        const QStringList size = parser.value(sizeOption).split('x');
+        if (size.size() == 2) options.size = QSize(size[0].toInt(), size[1].toInt());
+        options.frameDir = parser.value(framesOption);
+        options.rawPath = parser.value(rawOption);
+        options.timingsPath = parser.value(timingsOption);
+        if (options.ticks <= 0 || options.fps <= 0 || options.size.isEmpty()) {
+            QTextStream(stderr) << "Invalid --ticks, --fps or --size value" << Qt::endl;
+            return 1;
+        }
+        return w.runOffscreen(options);
+    }
     w.show();
     return a.exec();
 }
@@ -6,6 +6,13 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDebug>
+#include <QScreen>
+#include <QDir>
+#include <QTextStream>
+#include <algorithm>
+#include "dronedelegate.h"
+#include "profiler.h"
+#include "logging.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -19,32 +26,61 @@ MainWindow::MainWindow(QWidget *parent)
     // Create 5 drones initially
     int n=0;
     for (auto &pos : tabPos) {
-        QListWidgetItem *LWitems = new QListWidgetItem(ui->listDronesInfo);
-        ui->listDronesInfo->addItem(LWitems);
         QString name = "Drone" + QString::number(++n);
 
-        mapDrones[name] = new Drone(name);
-        mapDrones[name]->setInitialPosition(pos);
-
-        ui->listDronesInfo->setItemWidget(LWitems, mapDrones[name]);
+        Drone *drone = new Drone(&fleet, fleet.add(name, pos));
+        mapDrones[name] = drone;
+        fleetDrones.append(drone);
     }
 
+    // List of the drones: a row per drone, painted only when visible
+    droneList = new DroneListModel(&fleet, this);
+    ui->listDronesInfo->setModel(droneList);
+    ui->listDronesInfo->setItemDelegate(new DroneDelegate(ui->listDronesInfo));
+
+#ifdef QT_DEBUG
+    // Check the vectorized flight kernel against the scalar code
+    DroneFleet::KernelAccuracy acc = DroneFleet::checkKernelAccuracy(fleet.getKernel());
+    qCInfo(lcSimulation) << "Flight kernel:" << DroneKernel::name(fleet.getKernel())
+             << "max errors: position" << acc.position << "speed" << acc.speed
+             << "azimut" << acc.azimut << "status mismatches" << acc.statusMismatches;
+#endif
+
+    // Slider to seek in a replayed recording
+    replaySlider = new QSlider(Qt::Horizontal, this);
+    replaySlider->setMinimumWidth(300);
+    replaySlider->hide();
+    ui->statusbar->addPermanentWidget(replaySlider);
+    connect(replaySlider, &QSlider::valueChanged, this, &MainWindow::seekReplay);
+
     // Let the canvas know about our drones
     ui->widget->setMap(&mapDrones);
+    ui->widget->setFleet(&fleet);
+    ui->widget->setWorkerPool(&fleet.getPool());
 
-    // Setup a timer to update drones
+    // Setup a timer to update drones: the simulation only marks the frame dirty
     timer = new QTimer(this);
-    timer->setInterval(100);
+    timer->setInterval(qRound(simClock.getFixedDt() * 1000));
     connect(timer, SIGNAL(timeout()), this, SLOT(update()));
     timer->start();
 
+    // One render pass per display frame, drawing the latest state
+    const double refreshRate = screen() ? screen()->refreshRate() : 60.0;
+    renderTimer = new QTimer(this);
+    renderTimer->setTimerType(Qt::PreciseTimer);
+    renderTimer->setInterval(qMax(1, qRound(1000.0 / (refreshRate > 0 ? refreshRate : 60.0))));
+    connect(renderTimer, &QTimer::timeout, this, &MainWindow::render);
+    renderTimer->start();
+
     // Start our elapsed timer
     elapsedTimer.start();
+    simClock.reset(elapsedTimer.elapsed());
 }
 
 MainWindow::~MainWindow() {
     delete ui;
     delete timer;
+    delete renderTimer;
     delete voronoi;
 }
 
@@ -58,39 +94,55 @@ void MainWindow::on_actionLoad_triggered()
     QString filePath = QFileDialog::getOpenFileName(this, "Open JSON File", "", "JSON Files (*.json)");
     if (filePath.isEmpty()) return;
 
+    QString error;
+    if (!loadConfig(filePath, &error)) {
+        QMessageBox::warning(this, "Error", error);
+        return;
+    }
+
+    // Force a repaint
+    repaint();
+}
+
+bool MainWindow::loadConfig(const QString &filePath, QString *error)
+{
     // Clear existing servers
     for (Server *server : servers) {
         delete server;
     }
     servers.clear();
 
-    // Clear existing drones
-    for (auto &drone : mapDrones) {
+    // Clear existing drones (all of them, even those whose name was reused)
+    for (Drone *drone : fleetDrones) {
         delete drone;
     }
     mapDrones.clear();
-    ui->listDronesInfo->clear(); // Clear the UI list of drones
+    fleetDrones.clear();
+    recorder.close();
+    ui->actionRecord->setChecked(false);
+    fleet.clear();
+    droneList->reload(); // Clear the UI list of drones
 
     // Open JSON
     QFile file(filePath);
     if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "Error", "Cannot open JSON file!");
-        return;
+        if (error) *error = "Cannot open JSON file!";
+        return false;
     }
 
     QByteArray fileData = file.readAll();
     QJsonDocument jsonDoc = QJsonDocument::fromJson(fileData);
 
     if (!jsonDoc.isObject()) {
-        QMessageBox::warning(this, "Error", "Invalid JSON format!");
-        return;
+        if (error) *error = "Invalid JSON format!";
+        return false;
     }
 
     QJsonObject jsonObj = jsonDoc.object();
 
     // Parse servers from JSON
     QJsonArray serversArray = jsonObj["servers"].toArray();
-    MyPolygon polygon(serversArray.size()); // Assuming maximum of one vertex per server
+    allPoints.clear();
 
     for (const QJsonValue &serverVal : serversArray) {
         QJsonObject serverObj = serverVal.toObject();
@@ -107,38 +159,11 @@ void MainWindow::on_actionLoad_triggered()
     }
     ui->widget->clear();
 
-
-    // Compute convex hull
-    for (const Vector2D& point : allPoints) {
-        polygon.addVertex(point.x, point.y);
-    }
-    polygon.computeConvexHull();
-
-    // Clear the canvas
-
-    // The points in polygon.tabPts are now the convex hull points
-    // Add non-hull points as interior points
-    QVector<Vector2D> hullPoints = polygon.getHullVertices();
-
-    for (const Vector2D& point : allPoints) {
-        bool isInterior = true;
-        for (const Vector2D& hullPoint : hullPoints) {
-            if (point == hullPoint) {
-                isInterior = false;
-                break;
-            }
-        }
-        if (isInterior) {
-            polygon.addInteriorPoint(point);
-        }
-    }
-    qDebug()<<"Calling flip itt33333";
-
-    // Perform ear-clipping triangulation
-    polygon.earClippingTriangulate();
-    polygon.integrateInteriorPoints(); // Integrate interior points
-   //ui->widget->flippAll();
-     ui->widget->setPolygon(polygon);
+    // Delaunay triangulation of the servers
+    QElapsedTimer triangulationTimer;
+    triangulationTimer.start();
+    ui->widget->triangulate(allPoints);
+    Profiler::record(Profiler::triangulation, triangulationTimer.nsecsElapsed());
      ui->widget->setServers(servers);
 
     // Generate Voronoi cells and repaint
@@ -147,6 +172,7 @@ void MainWindow::on_actionLoad_triggered()
 
     // Parse drones from JSON
     QJsonArray dronesArray = jsonObj["drones"].toArray();
+    fleet.reserve(dronesArray.size());
     for (const QJsonValue &droneVal : dronesArray) {
         QJsonObject droneObj = droneVal.toObject();
         QString name = droneObj["name"].toString();
@@ -155,61 +181,223 @@ void MainWindow::on_actionLoad_triggered()
         QStringList posList = positionStr.split(",");
         if (posList.size() == 2) {
             Vector2D position(posList[0].toDouble(), posList[1].toDouble());
-            mapDrones[name] = new Drone(name);
-            mapDrones[name]->setInitialPosition(position);
-
-            // Add drone to the UI list
-            QListWidgetItem *LWitems = new QListWidgetItem(ui->listDronesInfo);
-            ui->listDronesInfo->addItem(LWitems);
-            ui->listDronesInfo->setItemWidget(LWitems, mapDrones[name]);
+            Drone *drone = new Drone(&fleet, fleet.add(name, position));
+            mapDrones[name] = drone;
+            fleetDrones.append(drone);
         }
     }
+    droneList->reload(); // Add the drones to the UI list
 
     ui->widget->setMap(&mapDrones);
     distributeDronesEqually();
-
-    // Force a repaint
-    repaint();
+    return true;
 }
 
 
+int MainWindow::runOffscreen(const OffscreenOptions &options)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    timer->stop();
+    renderTimer->stop();
+
+    QString error;
+    if (!loadConfig(options.configPath, &error)) {
+        err << options.configPath << ": " << error << Qt::endl;
+        return 1;
+    }
+    QFile raw(options.rawPath);
+    if (!options.rawPath.isEmpty() && !raw.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        err << options.rawPath << ": cannot create the frame stream" << Qt::endl;
+        return 1;
+    }
+    if (!options.frameDir.isEmpty() && !QDir().mkpath(options.frameDir)) {
+        err << options.frameDir << ": cannot create the directory" << Qt::endl;
+        return 1;
+    }
+
+    // each drone flies to the next server
+    for (int s = 0; s < servers.size(); s++) {
+        const Vector2D goal = servers[(s + 1) % servers.size()]->getPosition();
+        for (Drone *drone : servers[s]->getDrones()) {
+            drone->setGoalPosition(goal);
+            drone->start();
+        }
+    }
+
+    // the canvas is rendered alone, at the requested size
+    Canvas *canvas = ui->widget;
+    canvas->setFixedSize(options.size);
+    QImage frame(options.size, QImage::Format_RGB32);
+    out << "# config: " << options.configPath << ", drones: " << fleet.size() << ", servers: " << servers.size() << Qt::endl;
+    out << "# frames: " << options.size.width() << "x" << options.size.height() << " at " << options.fps << " fps";
+    if (raw.isOpen()) out << ", raw stream: bgra";
+    out << Qt::endl;
+    out << "frame,steps,render_ms" << Qt::endl;
+
+    // simulated time only: the run is reproducible, whatever the speed of the machine
+    SimulationClock clock(simClock.getFixedDt(), options.ticks + 1);
+    clock.reset(0);
+    QVector<double> renderTimes;
+    int ticks = 0;
+    for (int n = 0; ticks < options.ticks; n++) {
+        const qint64 now = qRound64((n + 1) * 1000.0 / options.fps);
+        const int steps = qMin(clock.advance(now), options.ticks - ticks);
+        ticks += steps;
+        for (int step = 0; step < steps; step++) {
+            fleet.step(clock.getFixedDt(), canvas->droneCollisionDistance);
+            handOverLandings();
+        }
+        canvas->setInterpolation(clock.getAlphaAt(now));
+
+        QElapsedTimer renderTimer;
+        renderTimer.start();
+        canvas->render(&frame);
+        const double renderMs = renderTimer.nsecsElapsed() * 1e-6;
+        renderTimes.append(renderMs);
+        out << n << "," << steps << "," << QString::number(renderMs, 'f', 3) << Qt::endl;
+
+        if (!options.frameDir.isEmpty()) {
+            frame.save(QDir(options.frameDir).filePath(QString("frame_%1.png").arg(n, 5, 10, QChar('0'))));
+        }
+        if (raw.isOpen()) {
+            raw.write(reinterpret_cast<const char *>(frame.constBits()), frame.sizeInBytes());
+        }
+    }
+
+    if (!renderTimes.isEmpty()) {
+        std::sort(renderTimes.begin(), renderTimes.end());
+        out << "# render ms: p50 " << QString::number(renderTimes[renderTimes.size() / 2], 'f', 3)
+            << ", p99 " << QString::number(renderTimes[qMin(renderTimes.size() - 1, int(renderTimes.size() * 0.99))], 'f', 3)
+            << ", max " << QString::number(renderTimes.last(), 'f', 3) << Qt::endl;
+    }
+    if (!options.timingsPath.isEmpty() && !Profiler::dumpJson(options.timingsPath)) {
+        err << options.timingsPath << ": cannot write the timings" << Qt::endl;
+        return 1;
+    }
+    return 0;
+}
+
 void MainWindow::update()
 {
-    static int last = elapsedTimer.elapsed();
-    static int steps = 5;
+    ScopedTimer tickTimer(Profiler::tick);
+    qint64 current = elapsedTimer.elapsed();
+    int steps = simClock.advance(current);
 
-    int current = elapsedTimer.elapsed();
-    double dt = (current - last) / (1000.0 * steps);
+    if (replay.isOpen()) {
+        // Replay mode: play the recording at the simulation speed
+        replaySlider->setValue(qMin(replaySlider->value() + steps, replaySlider->maximum()));
+        return;
+    }
 
-    // Sub-steps
+    // Fixed sub-steps
     for (int step = 0; step < steps; step++) {
-        // update each drone
-        for (auto &drone : mapDrones) {
-            if (drone->getStatus() != Drone::landed) {
-                drone->initCollision();
-                // collision detection with other drones
-                for (auto &obs : mapDrones) {
-                    if (obs->getStatus() != Drone::landed &&
-                        obs->getName() != drone->getName()) {
-                        Vector2D B = obs->getPosition();
-                        drone->addCollision(B, ui->widget->droneCollisionDistance);
-                    }
-                }
-            }
-            drone->update(dt);
-        }
+        fleet.step(simClock.getFixedDt(), ui->widget->droneCollisionDistance);
+        handOverLandings();
+        recorder.record(fleet);
+    }
+    if (steps > 0) {
+        lastTickSteps = steps;
+        lastTickDuration = elapsedTimer.elapsed() - current;
+        frameDirty = true;
+    }
+}
+
+void MainWindow::handOverLandings()
+{
+    for (int i : fleet.getLandings()) {
+        Server *server = ui->widget->findNearestServer(fleet.getPosition(i));
+        if (server) server->addDrone(fleetDrones[i]);
+    }
+}
+
+void MainWindow::render()
+{
+    if (replay.isOpen()) return;
+
+    // the flying drones move between two steps: interpolate at the time of the frame
+    if (fleet.getActiveCount() > 0) frameDirty = true;
+    if (!frameDirty) return;
+    frameDirty = false;
+
+    // refresh the visible rows of the drone list
+    {
+        ScopedTimer timer(Profiler::widgetUpdate);
+        droneList->refresh();
+    }
+
+    ui->statusbar->showMessage("Duration: " + QString::number(lastTickDuration) + " ms, Steps: " + QString::number(lastTickSteps)
+                               + ", Pairs: " + QString::number(fleet.getCollisionPairCount())
+                               + ", Dropped: " + QString::number(simClock.getDroppedSteps()));
+
+    ui->widget->setInterpolation(simClock.getAlphaAt(elapsedTimer.elapsed()));
+    ui->widget->update();
+}
+
+void MainWindow::on_actionRecord_triggered(bool checked)
+{
+    recorder.close();
+    if (!checked) return;
+
+    QString filePath = QFileDialog::getSaveFileName(this, "Record trajectories", "", "Trajectory Files (*.traj)");
+    if (filePath.isEmpty() || !recorder.open(filePath, fleet, simClock.getFixedDt())) {
+        if (!filePath.isEmpty()) QMessageBox::warning(this, "Error", "Cannot create trajectory file!");
+        ui->actionRecord->setChecked(false);
     }
+}
 
-    int d = elapsedTimer.elapsed() - current;
-    ui->statusbar->showMessage("Duration: " + QString::number(d) + " ms, Steps: " + QString::number(steps));
-    if (d > 90) {
-        steps /= 2;
+void MainWindow::on_actionReplay_triggered(bool checked)
+{
+    replay.close();
+    ui->widget->setReplay(nullptr);
+    replaySlider->hide();
+
+    if (checked) {
+        QString filePath = QFileDialog::getOpenFileName(this, "Replay trajectories", "", "Trajectory Files (*.traj)");
+        if (!filePath.isEmpty() && !replay.open(filePath)) {
+            QMessageBox::warning(this, "Error", "Invalid trajectory file!");
+        }
+        if (replay.isOpen()) {
+            replaySlider->setRange(0, qMax(0, replay.getTickCount() - 1));
+            replaySlider->setValue(0);
+            replaySlider->show();
+            ui->widget->setReplay(&replay);
+        } else {
+            ui->actionReplay->setChecked(false);
+        }
     } else {
-        if (steps < 10) steps++;
+        // back to the live simulation, without running the paused time
+        simClock.reset(elapsedTimer.elapsed());
+    }
+    ui->widget->update();
+}
+
+void MainWindow::seekReplay(int tick)
+{
+    if (!replay.seek(tick)) return;
+    ui->statusbar->showMessage("Replay: step " + QString::number(tick + 1) + "/" + QString::number(replay.getTickCount())
+                               + ", time: " + QString::number(tick * replay.getDt(), 'f', 2) + " s");
+    ui->widget->update();
+}
+
+void MainWindow::on_actionShowTimings_triggered(bool checked)
+{
+    ui->widget->showProfiler = checked;
+    ui->widget->update();
+}
+
+void MainWindow::on_actionSaveTimings_triggered()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "Save timings", "", "JSON Files (*.json)");
+    if (filePath.isEmpty()) return;
+    if (!Profiler::dumpJson(filePath)) {
+        QMessageBox::warning(this, "Error", "Cannot write timings file!");
     }
-    last = current;
+}
 
-    ui->widget->repaint();
+void MainWindow::setFullValidation(bool enabled)
+{
+    ui->widget->fullValidation = enabled;
 }
 
 // --- New toggles for Show Centers / Show Delaunay ---
@@ -218,13 +406,16 @@ void MainWindow::on_actionshowCenters_triggered(bool checked)
 {
     // Toggle the boolean in the Canvas
     ui->widget->showCenters = checked;
-    ui->widget->flippAll();
+    const Triangle::FlipReport report = ui->widget->flippAll();
+    ui->statusbar->showMessage("Flips: " + QString::number(report.flipped) + ", edge tests: " + QString::number(report.tested)
+                               + (report.delaunay ? "" : ", not Delaunay"));
 
     ui->widget->update();
 }
 void MainWindow::on_actionshowCircles_triggered(bool checked)
 {
 ui->widget->showCircles=checked;
+    ui->widget->invalidateStaticLayer();
     update();
 }
 void MainWindow::on_actionshowDelaunay_triggered(bool checked)
@@ -239,13 +430,16 @@ void MainWindow::on_actionshowDelaunay_triggered(bool checked)
 void MainWindow::distributeDronesEqually() {
     int serverIndex = 0;
     const int serverCount = servers.size();  // Assuming 'servers' is a QVector<Server*>
+    if (serverCount == 0) {
+        if (!mapDrones.isEmpty()) qCWarning(lcSimulation) << "No server to receive the" << mapDrones.size() << "drones.";
+        return;
+    }
 
     QMapIterator<QString, Drone*> i(mapDrones);
     while (i.hasNext()) {
         i.next();
         Drone* drone = i.value();
-        // Assuming each server has a 'name' property
-        drone->setServerName(servers[serverIndex]->getName());
+        // the drone keeps a pointer on its server
         servers[serverIndex]->addDrone(drone);
         serverIndex = (serverIndex + 1) % serverCount;  // Round-robin distribution
     }
@@ -255,7 +449,7 @@ void MainWindow::on_actionshowVoronoi_triggered() {
     Canvas* canvas = ui->widget;
 
     if (!canvas) {
-        qDebug() << "Canvas not found.";
+        qCWarning(lcMesh) << "Canvas not found.";
         return;
     }
 
@@ -10,11 +10,31 @@
 #include <QMap>
 #include <QTimer>
 #include <QElapsedTimer>
+#include <QSlider>
 #include <drone.h>
+#include "dronefleet.h"
+#include "dronelistmodel.h"
+#include "simulationclock.h"
+#include "trajectoryrecorder.h"
+#include "trajectoryreader.h"
 #include <vector2d.h>
 #include <server.h>
 #include <mypolygon.h>
 #include "voronoi.h"
+
+/**
+ * @brief Options of the offscreen rendering, given on the command line
+ */
+struct OffscreenOptions {
+    QString configPath;  ///< JSON file of the servers and drones
+    int ticks = 500;     ///< number of simulation steps to run
+    double fps = 30;     ///< frames per second of simulated time
+    QSize size = QSize(1024, 768); ///< size of the frames (pixels)
+    QString frameDir;    ///< directory of the numbered PNG files, none if empty
+    QString rawPath;     ///< file of the raw frame stream (BGRA bytes), none if empty
+    QString timingsPath; ///< JSON file of the phase timings, none if empty
+};
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -51,6 +71,30 @@ public:
      */
     ~MainWindow();
 
+    /**
+     * @brief Loads the servers and drones of a JSON file and builds the triangulation.
+     * @param filePath Path to the JSON file to be loaded.
+     * @param error Receives the reason of a failure, if not nullptr.
+     * @return false if the file cannot be read.
+     */
+    bool loadConfig(const QString &filePath, QString *error = nullptr);
+
+    /**
+     * @brief Runs the simulation without display and renders the canvas in images at a fixed frame rate.
+     *
+     * Every drone flies to the server following its own one. One CSV line per frame is printed on the
+     * standard output: frame,steps,render_ms.
+     * @param options Configuration, duration and outputs of the run.
+     * @return the exit code of the application, 0 on success.
+     */
+    int runOffscreen(const OffscreenOptions &options);
+
+    /**
+     * @brief Enables the full validation of the triangulation after each Delaunay certification.
+     * @param enabled True to test every triangle against every vertex, for debugging.
+     */
+    void setFullValidation(bool enabled);
+
 private slots:
     /**
      * @brief Slot to handle the "Quit" action triggered from the GUI.
@@ -62,11 +106,41 @@ private slots:
      */
     void update();
 
+    /**
+     * @brief Draws the latest simulated state, if it changed, once per display frame.
+     */
+    void render();
+
     /**
      * @brief Slot to handle the "Load" action to load configuration or data files.
      */
     void on_actionLoad_triggered();
 
+    /**
+     * @brief Starts or stops the recording of the drone trajectories in a binary file.
+     * @param checked Whether the recording must be running.
+     */
+    void on_actionRecord_triggered(bool checked);
+    /**
+     * @brief Enters or leaves the replay of a recorded file, the simulation being paused meanwhile.
+     * @param checked Whether the replay mode must be active.
+     */
+    void on_actionReplay_triggered(bool checked);
+    /**
+     * @brief Shows the recorded step selected with the replay slider.
+     * @param tick Index of the step.
+     */
+    void seekReplay(int tick);
+    /**
+     * @brief Toggles the panel of the timings of the phases over the canvas.
+     * @param checked Whether the panel should be shown or not.
+     */
+    void on_actionShowTimings_triggered(bool checked);
+    /**
+     * @brief Saves the timing histograms of the phases in a JSON file.
+     */
+    void on_actionSaveTimings_triggered();
+
     /**
      * @brief Toggles the visibility of centers in the visualization.
      * @param checked Whether the centers should be shown or not.
@@ -89,9 +163,20 @@ private slots:
 
 private:
     Ui::MainWindow *ui;///< Pointer to the user interface.
+    DroneFleet fleet; ///< Simulation engine holding the state of all the drones.
     QMap<QString,Drone*> mapDrones;///< Map of drone identifiers to Drone objects.
+    QVector<Drone*> fleetDrones; ///< Drone objects by index in the fleet.
+    DroneListModel *droneList; ///< Rows of the list of the drones, read from the fleet.
     QTimer *timer; ///< Timer for periodic updates and operations
+    QTimer *renderTimer; ///< Timer of the display frames
+    bool frameDirty = true; ///< True if the state changed since the last rendered frame
+    qint64 lastTickDuration = 0; ///< Duration of the last simulation tick (ms)
+    int lastTickSteps = 0; ///< Number of steps run by the last simulation tick
     QElapsedTimer elapsedTimer;///< Timer for measuring elapsed time.
+    SimulationClock simClock; ///< Fixed time step clock of the simulation.
+    TrajectoryRecorder recorder; ///< Log of the drone states, written after each step when recording.
+    TrajectoryReader replay; ///< Recorded file shown in replay mode.
+    QSlider *replaySlider; ///< Step of the replay, in the status bar.
     MyPolygon *polygon;///< Pointer to a polygon used in the application.
 
     /**
@@ -102,5 +187,10 @@ private:
     QVector<Vector2D> allPoints; ///< List of all points used in visualizations.
     Voronoi* voronoi; ///< Pointer to the Voronoi diagram manager.
 
+    /**
+     * @brief Hands the drones which landed during the last step over to the server they landed on, the nearest one.
+     */
+    void handOverLandings();
+
 };
 #endif // MAINWINDOW_H
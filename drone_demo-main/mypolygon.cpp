@@ -6,6 +6,8 @@
 #include <QDebug>
 #include <QVector>
 #include <triangle.h>
+#include "logging.h"
+#include "predicates.h"
 MyPolygon::MyPolygon(int p_Nmax) : Nmax(p_Nmax)
 {
     N = 0;
@@ -24,7 +26,7 @@ void MyPolygon::addVertex(float x, float y)
         tabPts[N] = Vector2D(x, y);
         N++;
     } else {
-        qDebug() << "Error: Max number of vertices (" << Nmax << ") reached!";
+        qCWarning(lcMesh) << "Error: Max number of vertices (" << Nmax << ") reached!";
     }
 }
 
@@ -56,7 +58,7 @@ void MyPolygon::changeColor(const Vector2D &pt)
 {
     // Placeholder: you might detect if pt is inside polygon, then do something
     // For now, just log
-    qDebug() << "changeColor called with pt:" << pt.x << pt.y << "(not implemented)";
+    qCDebug(lcMesh) << "changeColor called with pt:" << pt.x << pt.y << "(not implemented)";
 }
 
 Vector2D *MyPolygon::getVertices(int &n)
@@ -115,9 +117,9 @@ void MyPolygon::ensureCCW()
             tabPts[i] = tabPts[N-1 - i];
             tabPts[N-1 - i] = tmp;
         }
-        qDebug() << "Polygon reversed to ensure CCW orientation.";
+        qCDebug(lcMesh) << "Polygon reversed to ensure CCW orientation.";
     } else {
-        qDebug() << "Polygon is already CCW (or degenerate). area =" << area;
+        qCDebug(lcMesh) << "Polygon is already CCW (or degenerate). area =" << area;
     }
 }
 
@@ -152,7 +154,7 @@ void MyPolygon::earClippingTriangulate()
     }
 
     if (poly.size() < 3) {
-        qDebug() << "Not enough points to form a polygon.";
+        qCWarning(lcMesh) << "Not enough points to form a polygon.";
         return;
     }
 
@@ -185,7 +187,7 @@ void MyPolygon::earClippingTriangulate()
         }
 
         if (!earFound) {
-            qDebug() << "Ear not found. Polygon may be self-intersecting or invalid.";
+            qCWarning(lcMesh) << "Ear not found. Polygon may be self-intersecting or invalid.";
             return; // Exit if the polygon is invalid
         }
     }
@@ -196,7 +198,7 @@ void MyPolygon::earClippingTriangulate()
         triangles.push_back(tri);
     }
 
-    qDebug() << "Ear clipping done. Triangles formed:" << triangles.size();
+    qCDebug(lcMesh) << "Ear clipping done. Triangles formed:" << triangles.size();
 }
 
 
@@ -215,10 +217,7 @@ bool MyPolygon::isEar(const QVector<Vector2D*> &poly, int i) const
     const Vector2D *B = poly[i];
     const Vector2D *C = poly[iNext];
 
-    Vector2D AB = *B - *A;
-    Vector2D BC = *C - *B;
-    float crossVal = AB.x * BC.y - AB.y * BC.x;
-    if (crossVal < 0.0f) {
+    if (Predicates::orient2d(*A, *B, *C) < 0) {
         return false; // Reflex angle, not an ear
     }
 
@@ -234,24 +233,21 @@ bool MyPolygon::isEar(const QVector<Vector2D*> &poly, int i) const
 
 
 // --------------------------------------------------
-// Check if point p is inside triangle ABC
-// (using area-based approach)
+// Check if point p is inside triangle ABC or on its border
+// (same side of the three edges, with exact orientations)
 // --------------------------------------------------
 bool MyPolygon::pointInTriangle(const Vector2D &p,
                                 const Vector2D &A,
                                 const Vector2D &B,
                                 const Vector2D &C) const
 {
-    auto cross = [](const Vector2D &u, const Vector2D &v) {
-        return u.x * v.y - u.y * v.x;
-    };
+    const double d1 = Predicates::orient2d(A, B, p);
+    const double d2 = Predicates::orient2d(B, C, p);
+    const double d3 = Predicates::orient2d(C, A, p);
+    const bool hasNegative = d1 < 0 || d2 < 0 || d3 < 0;
+    const bool hasPositive = d1 > 0 || d2 > 0 || d3 > 0;
 
-    float areaABC = std::fabs(cross(B - A, C - A));
-    float areaPAB = std::fabs(cross(p - A, B - A));
-    float areaPBC = std::fabs(cross(p - B, C - B));
-    float areaPCA = std::fabs(cross(p - C, A - C));
-
-    return (std::fabs(areaABC - (areaPAB + areaPBC + areaPCA)) < 1e-5);
+    return !(hasNegative && hasPositive);
 }
 void MyPolygon::computeConvexHull() {
     QVector<Vector2D> points(tabPts, tabPts + N);  // Assuming points are already loaded into tabPts
@@ -264,7 +260,7 @@ void MyPolygon::computeConvexHull() {
 
     // Build lower hull
     for (int i = 0; i < points.size(); ++i) {
-        while (hull.size() >= 2 && ((hull.back() - hull[hull.size() - 2]) ^ (points[i] - hull.back())) <= 0)
+        while (hull.size() >= 2 && Predicates::orient2d(hull[hull.size() - 2], hull.back(), points[i]) <= 0)
             hull.pop_back();
         hull.push_back(points[i]);
     }
@@ -272,7 +268,7 @@ void MyPolygon::computeConvexHull() {
     // Build upper hull
     int t = hull.size() + 1;
     for (int i = points.size() - 1; i >= 0; --i) {
-        while (hull.size() >= t && ((hull.back() - hull[hull.size() - 2]) ^ (points[i] - hull.back())) <= 0)
+        while (hull.size() >= t && Predicates::orient2d(hull[hull.size() - 2], hull.back(), points[i]) <= 0)
             hull.pop_back();
         hull.push_back(points[i]);
     }
@@ -343,7 +339,7 @@ void MyPolygon::integrateInteriorPoints() {
 
     // Replace old triangles with the new set
     triangles = newTriangles;
-    qDebug() << "Updated triangulation with interior points. Total triangles: " << triangles.size();
+    qCDebug(lcMesh) << "Updated triangulation with interior points. Total triangles: " << triangles.size();
 
     // Pass the updated triangles to the Triangle class
     Triangle::setTriangles(triangles);
@@ -22,7 +22,6 @@ private:
     QVector<Triangle> triangles; ///< result of ear clipping
 
 public:
-    void flippIt(QVector<Triangle> &triangles);
     bool isOnTheLeft(const Vector2D *P, const Vector2D *P1, const Vector2D *P2);
 
     bool isInside(Vector2D &P);
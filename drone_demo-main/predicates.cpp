@@ -0,0 +1,156 @@
+#include "predicates.h"
+#include <QVector>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+//-------------------------------------
+// floating-point expansions: sums of non overlapping doubles, by increasing magnitude,
+// representing a value exactly (Shewchuk, "Adaptive Precision Floating-Point Arithmetic
+// and Fast Robust Geometric Predicates", 1997)
+
+typedef QVector<double> Expansion;
+
+static std::atomic<quint64> exactCount(0);
+
+/**
+ * @brief x+y=a+b exactly, x being the rounded sum
+ */
+static inline void twoSum(double a,double b,double &x,double &y) {
+    x=a+b;
+    const double bv=x-a;
+    const double av=x-bv;
+    y=(a-av)+(b-bv);
+}
+
+/**
+ * @brief x+y=a*b exactly, x being the rounded product
+ */
+static inline void twoProduct(double a,double b,double &x,double &y) {
+    x=a*b;
+    y=std::fma(a,b,-x);
+}
+
+static Expansion difference(double a,double b) {
+    double x,y;
+    twoSum(a,-b,x,y);
+    Expansion e;
+    if (y!=0) e.append(y);
+    if (x!=0 || e.isEmpty()) e.append(x);
+    return e;
+}
+
+static Expansion grow(const Expansion &e,double b) {
+    Expansion h;
+    h.reserve(e.size()+1);
+    double q=b;
+    for (double ei:e) {
+        double hh;
+        twoSum(q,ei,q,hh);
+        if (hh!=0) h.append(hh);
+    }
+    if (q!=0 || h.isEmpty()) h.append(q);
+    return h;
+}
+
+static Expansion sum(const Expansion &e,const Expansion &f) {
+    Expansion h=e;
+    for (double fi:f) h=grow(h,fi);
+    return h;
+}
+
+static Expansion scale(const Expansion &e,double b) {
+    Expansion h;
+    h.reserve(2*e.size());
+    double q,hh;
+    twoProduct(e[0],b,q,hh);
+    if (hh!=0) h.append(hh);
+    for (int i=1; i<e.size(); i++) {
+        double p1,p0,s;
+        twoProduct(e[i],b,p1,p0);
+        twoSum(q,p0,s,hh);
+        if (hh!=0) h.append(hh);
+        twoSum(p1,s,q,hh);
+        if (hh!=0) h.append(hh);
+    }
+    if (q!=0 || h.isEmpty()) h.append(q);
+    return h;
+}
+
+static Expansion product(const Expansion &e,const Expansion &f) {
+    Expansion h;
+    for (double fi:f) h=sum(h,scale(e,fi));
+    return h;
+}
+
+static Expansion negate(Expansion e) {
+    for (double &x:e) x=-x;
+    return e;
+}
+
+/**
+ * @brief The most significant component, which has the sign of the expansion
+ */
+static inline double estimate(const Expansion &e) {
+    return e.isEmpty()?0:e.last();
+}
+
+//-------------------------------------
+static const double epsilon=std::numeric_limits<double>::epsilon()/2;     // 2^-53
+static const double orientBound=(3.0+16.0*epsilon)*epsilon;
+static const double incircleBound=(10.0+96.0*epsilon)*epsilon;
+
+static double orient2dExact(double ax,double ay,double bx,double by,double cx,double cy) {
+    const Expansion acx=difference(ax,cx),acy=difference(ay,cy);
+    const Expansion bcx=difference(bx,cx),bcy=difference(by,cy);
+    return estimate(sum(product(acx,bcy),negate(product(acy,bcx))));
+}
+
+double Predicates::orient2d(double ax,double ay,double bx,double by,double cx,double cy) {
+    const double left=(ax-cx)*(by-cy);
+    const double right=(ay-cy)*(bx-cx);
+    const double det=left-right;
+    const double bound=orientBound*(std::fabs(left)+std::fabs(right));
+    if (det>bound || -det>bound) return det;
+    exactCount.fetch_add(1,std::memory_order_relaxed);
+    return orient2dExact(ax,ay,bx,by,cx,cy);
+}
+
+static double incircleExact(double ax,double ay,double bx,double by,double cx,double cy,double dx,double dy) {
+    const Expansion adx=difference(ax,dx),ady=difference(ay,dy);
+    const Expansion bdx=difference(bx,dx),bdy=difference(by,dy);
+    const Expansion cdx=difference(cx,dx),cdy=difference(cy,dy);
+    const Expansion bc=sum(product(bdx,cdy),negate(product(cdx,bdy)));
+    const Expansion ca=sum(product(cdx,ady),negate(product(adx,cdy)));
+    const Expansion ab=sum(product(adx,bdy),negate(product(bdx,ady)));
+    const Expansion alift=sum(product(adx,adx),product(ady,ady));
+    const Expansion blift=sum(product(bdx,bdx),product(bdy,bdy));
+    const Expansion clift=sum(product(cdx,cdx),product(cdy,cdy));
+    return estimate(sum(sum(product(alift,bc),product(blift,ca)),product(clift,ab)));
+}
+
+double Predicates::incircle(double ax,double ay,double bx,double by,double cx,double cy,double dx,double dy) {
+    const double adx=ax-dx,ady=ay-dy;
+    const double bdx=bx-dx,bdy=by-dy;
+    const double cdx=cx-dx,cdy=cy-dy;
+
+    const double bdxcdy=bdx*cdy,cdxbdy=cdx*bdy;
+    const double alift=adx*adx+ady*ady;
+    const double cdxady=cdx*ady,adxcdy=adx*cdy;
+    const double blift=bdx*bdx+bdy*bdy;
+    const double adxbdy=adx*bdy,bdxady=bdx*ady;
+    const double clift=cdx*cdx+cdy*cdy;
+
+    const double det=alift*(bdxcdy-cdxbdy)+blift*(cdxady-adxcdy)+clift*(adxbdy-bdxady);
+    const double permanent=(std::fabs(bdxcdy)+std::fabs(cdxbdy))*alift
+                          +(std::fabs(cdxady)+std::fabs(adxcdy))*blift
+                          +(std::fabs(adxbdy)+std::fabs(bdxady))*clift;
+    const double bound=incircleBound*permanent;
+    if (det>bound || -det>bound) return det;
+    exactCount.fetch_add(1,std::memory_order_relaxed);
+    return incircleExact(ax,ay,bx,by,cx,cy,dx,dy);
+}
+
+quint64 Predicates::getExactCount() {
+    return exactCount.load(std::memory_order_relaxed);
+}
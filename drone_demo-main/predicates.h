@@ -0,0 +1,49 @@
+/**
+ * @file predicates.h
+ * @brief Robust orientation and in-circle predicates.
+ */
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include <QtGlobal>
+#include "vector2d.h"
+
+/**
+ * @brief Geometric predicates with an exact sign, after J. R. Shewchuk's adaptive predicates
+ *
+ * Each predicate first evaluates its determinant in double precision with a bound of the rounding
+ * error: when the value is larger than the bound, its sign is exact and it is returned directly.
+ * Only the nearly degenerate cases (collinear or cocircular points) fall back to the exact
+ * evaluation with floating-point expansions, which is much slower but rarely needed.
+ *
+ * The orientations are those of a y axis going up (counterclockwise is positive): with the y axis
+ * of the screen going down, the signs are reversed but the tests stay consistent.
+ */
+namespace Predicates {
+    /**
+     * @brief Orientation of the triangle (a,b,c)
+     * @return A positive value if c is on the left of a->b (counterclockwise), negative if it is on the right, 0 if the points are collinear
+     */
+    double orient2d(double ax,double ay,double bx,double by,double cx,double cy);
+
+    /**
+     * @brief Position of d relative to the circle through a, b and c
+     * @return A positive value if d is inside the circle of the counterclockwise triangle (a,b,c), negative if it is outside,
+     * 0 if the points are cocircular. The sign is reversed for a clockwise triangle.
+     */
+    double incircle(double ax,double ay,double bx,double by,double cx,double cy,double dx,double dy);
+
+    inline double orient2d(const Vector2D &a,const Vector2D &b,const Vector2D &c) {
+        return orient2d(a.x,a.y,b.x,b.y,c.x,c.y);
+    }
+    inline double incircle(const Vector2D &a,const Vector2D &b,const Vector2D &c,const Vector2D &d) {
+        return incircle(a.x,a.y,b.x,b.y,c.x,c.y,d.x,d.y);
+    }
+
+    /**
+     * @brief Get the number of evaluations which needed the exact arithmetic since the start
+     */
+    quint64 getExactCount();
+}
+
+#endif // PREDICATES_H
@@ -0,0 +1,135 @@
+#include "profiler.h"
+#include <QFile>
+#include <QJsonDocument>
+
+std::mutex Profiler::registryMutex;
+std::vector<std::unique_ptr<Profiler::ThreadHistograms>> Profiler::registry;
+
+Profiler::ThreadHistograms &Profiler::local() {
+    thread_local ThreadHistograms *histograms=nullptr;
+    if (!histograms) {
+        // first record of this thread: the only locked operation
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadHistograms());
+        histograms=registry.back().get();
+    }
+    return *histograms;
+}
+
+int Profiler::bucketOf(qint64 ns) {
+    if (ns<4) return ns>0?int(ns):0;
+    const int msb=63-__builtin_clzll(quint64(ns));
+    const int bucket=msb*4+int((ns>>(msb-2))&3);
+    return bucket<bucketCount?bucket:bucketCount-1;
+}
+
+double Profiler::bucketValue(int bucket) {
+    if (bucket<8) return bucket; // exact values under 4 ns
+    // middle of the bucket
+    const int msb=bucket/4;
+    return (4+bucket%4+0.5)*double(qint64(1)<<(msb-2));
+}
+
+void Profiler::record(Phase phase,qint64 ns) {
+    // single writer per histogram: relaxed loads and stores are enough
+    Histogram &h=local().phases[phase];
+    std::atomic<quint32> &b=h.buckets[bucketOf(ns)];
+    b.store(b.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+    h.count.store(h.count.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+    h.total.store(h.total.load(std::memory_order_relaxed)+ns,std::memory_order_relaxed);
+    if (ns>h.max.load(std::memory_order_relaxed)) h.max.store(ns,std::memory_order_relaxed);
+}
+
+Profiler::PhaseStats Profiler::stats(Phase phase) {
+    quint64 buckets[bucketCount]={};
+    PhaseStats s;
+    qint64 total=0,max=0;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto &t:registry) {
+            const Histogram &h=t->phases[phase];
+            for (int i=0; i<bucketCount; i++) buckets[i]+=h.buckets[i].load(std::memory_order_relaxed);
+            s.count+=h.count.load(std::memory_order_relaxed);
+            total+=h.total.load(std::memory_order_relaxed);
+            max=qMax(max,h.max.load(std::memory_order_relaxed));
+        }
+    }
+    if (s.count==0) return s;
+
+    // the counters may be a little ahead of the buckets: use the sum of the buckets as reference
+    quint64 n=0;
+    for (int i=0; i<bucketCount; i++) n+=buckets[i];
+    const quint64 rank50=(n+1)/2,rank99=qMax<quint64>(1,quint64(n*0.99));
+    quint64 cumul=0;
+    bool has50=false;
+    for (int i=0; i<bucketCount; i++) {
+        cumul+=buckets[i];
+        if (!has50 && cumul>=rank50) {
+            s.p50=bucketValue(i);
+            has50=true;
+        }
+        if (cumul>=rank99) {
+            s.p99=bucketValue(i);
+            break;
+        }
+    }
+    s.total=total*1e-3;
+    s.max=max*1e-3;
+    s.p50=qMin(s.p50*1e-3,s.max);
+    s.p99=qMin(s.p99*1e-3,s.max);
+    return s;
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto &t:registry) {
+        for (Histogram &h:t->phases) {
+            for (auto &b:h.buckets) b.store(0,std::memory_order_relaxed);
+            h.count.store(0,std::memory_order_relaxed);
+            h.total.store(0,std::memory_order_relaxed);
+            h.max.store(0,std::memory_order_relaxed);
+        }
+    }
+}
+
+const char *Profiler::name(Phase phase) {
+    static const char *names[phaseCount]={
+        "tick","simulationStep","events","collisionBroad","collisionNarrow","integration",
+        "widgetUpdate","paint","paintTriangles","paintVoronoi","paintServers","paintDrones",
+        "triangulation","voronoi"
+    };
+    return phase<phaseCount?names[phase]:"";
+}
+
+QJsonObject Profiler::toJson() {
+    QJsonObject obj;
+    for (int p=0; p<phaseCount; p++) {
+        const PhaseStats s=stats(Phase(p));
+        QJsonObject phase;
+        phase["count"]=s.count;
+        phase["total_us"]=s.total;
+        phase["p50_us"]=s.p50;
+        phase["p99_us"]=s.p99;
+        phase["max_us"]=s.max;
+        obj[name(Phase(p))]=phase;
+    }
+    return obj;
+}
+
+bool Profiler::dumpJson(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    file.write(QJsonDocument(toJson()).toJson());
+    return true;
+}
+
+QString Profiler::summary() {
+    QString text=QString("%1 %2 %3 %4 %5\n").arg("phase",-16).arg("count",8).arg("p50 us",9).arg("p99 us",9).arg("max us",9);
+    for (int p=0; p<phaseCount; p++) {
+        const PhaseStats s=stats(Phase(p));
+        if (s.count==0) continue;
+        text+=QString("%1 %2 %3 %4 %5\n").arg(name(Phase(p)),-16).arg(s.count,8)
+                .arg(s.p50,9,'f',1).arg(s.p99,9,'f',1).arg(s.max,9,'f',1);
+    }
+    return text;
+}
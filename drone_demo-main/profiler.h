@@ -0,0 +1,132 @@
+/**
+ * @file profiler.h
+ * @brief Duration histograms of the phases of a simulation tick and of the drawing.
+ */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class Profiler
+ * @brief The Profiler class accumulates the durations of the phases of the application in histograms.
+ *
+ * Each thread records in its own histograms, created at its first record, so recording is a few
+ * relaxed atomic operations without lock nor contention. The histograms of all the threads are
+ * merged when they are read. The buckets are logarithmic, 4 per power of two (precision 19%),
+ * from 1 ns to 18 minutes.
+ */
+class Profiler {
+public:
+    /**
+     * @brief The measured phases
+     */
+    enum Phase {
+        tick,             ///< whole timer tick of the main window
+        simulationStep,   ///< one step of the fleet
+        events,           ///< status changes of the fleet
+        collisionBroad,   ///< update of the collision grid
+        collisionNarrow,  ///< collision tests with the neighbors (per task)
+        integration,      ///< motion of the flying drones (per task)
+        widgetUpdate,     ///< refresh of the drone widgets
+        paint,            ///< whole Canvas::paintEvent
+        paintTriangles,   ///< triangles, centers and circles layer
+        paintVoronoi,     ///< Voronoi edges layer
+        paintServers,     ///< servers layer
+        paintDrones,      ///< drones layer
+        triangulation,    ///< convex hull, ear clipping and interior points
+        voronoi,          ///< computation of the Voronoi edges
+        phaseCount
+    };
+
+    /**
+     * @brief Statistics of a phase, durations in microseconds
+     */
+    struct PhaseStats {
+        qint64 count=0;  ///< number of records
+        double total=0;  ///< sum of the durations
+        double p50=0;    ///< median
+        double p99=0;    ///< 99th percentile
+        double max=0;    ///< longest duration
+    };
+
+    /**
+     * @brief Add a duration to the histogram of a phase for the current thread
+     * @param phase measured phase
+     * @param ns duration (ns)
+     */
+    static void record(Phase phase,qint64 ns);
+    /**
+     * @brief Merge the histograms of all the threads for a phase
+     */
+    static PhaseStats stats(Phase phase);
+    /**
+     * @brief Empty all the histograms
+     */
+    static void reset();
+    /**
+     * @brief Get the name of a phase
+     */
+    static const char *name(Phase phase);
+    /**
+     * @brief Get the statistics of all the phases as a JSON object
+     */
+    static QJsonObject toJson();
+    /**
+     * @brief Write the statistics of all the phases in a JSON file
+     * @return false if the file cannot be written
+     */
+    static bool dumpJson(const QString &path);
+    /**
+     * @brief Get a text line per phase with records, for an overlay panel
+     */
+    static QString summary();
+
+    static constexpr int bucketCount=160; ///< 4 buckets per power of two up to 2^40 ns
+
+private:
+    /**
+     * @brief Histogram of one phase, written by a single thread
+     */
+    struct Histogram {
+        std::atomic<quint32> buckets[bucketCount]{};
+        std::atomic<qint64> count{0};
+        std::atomic<qint64> total{0};
+        std::atomic<qint64> max{0};
+    };
+    /**
+     * @brief Histograms of all the phases of one thread
+     */
+    struct ThreadHistograms {
+        Histogram phases[phaseCount];
+    };
+
+    static std::mutex registryMutex; ///< protects the registration of the threads
+    static std::vector<std::unique_ptr<ThreadHistograms>> registry; ///< histograms of the threads, kept until the end
+
+    static ThreadHistograms &local();
+    static int bucketOf(qint64 ns);
+    static double bucketValue(int bucket);
+};
+
+/**
+ * @class ScopedTimer
+ * @brief The ScopedTimer class records the time spent in a scope in the histogram of a phase.
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Profiler::Phase p_phase) : phase(p_phase) { timer.start(); }
+    ~ScopedTimer() { Profiler::record(phase,timer.nsecsElapsed()); }
+
+private:
+    Profiler::Phase phase; ///< measured phase
+    QElapsedTimer timer;   ///< start time
+};
+
+#endif // PROFILER_H
@@ -110,10 +110,67 @@ public:
     /**
      * @brief Add a drone to the server's management.
      *
+     * The drone is handed over: it is removed from the drones of its previous server, if any.
+     *
      * @param drone Pointer to the drone to be added.
      */
     void addDrone(Drone* drone) {
-        drones.append(drone);  // Correct use of QVector's append method
+        if (drone->getServer() != this) {
+            if (drone->getServer()) drone->getServer()->removeDrone(drone);
+            drones.append(drone);  // Correct use of QVector's append method
+            drone->setServer(this);
+        }
+        updateLandedCount(drone);
+    }
+
+    /**
+     * @brief Remove a drone from the server's management.
+     *
+     * @param drone Pointer to the drone to be removed.
+     */
+    void removeDrone(Drone* drone) {
+        if (drones.removeOne(drone)) {
+            launching.removeOne(drone);
+            if (drone->isCountedLanded()) {
+                landedCount--;
+                drone->setCountedLanded(false);
+            }
+            drone->setServer(nullptr);
+        }
+    }
+
+    /**
+     * @brief Update the count of the landed drones after a take off or a landing of one of the drones.
+     *
+     * @param drone Pointer to a drone managed by this server.
+     */
+    void updateLandedCount(Drone* drone) {
+        const bool landed = drone->getStatus() == Drone::landed;
+        if (landed != drone->isCountedLanded()) {
+            landedCount += landed ? 1 : -1;
+            drone->setCountedLanded(landed);
+            if (!landed) addLaunch(drone);
+        }
+    }
+
+    /**
+     * @brief Get the number of landed drones managed by this server, drawn on it.
+     *
+     * @return int Number of drones counted landed.
+     */
+    int getLandedCount() const {
+        return landedCount;
+    }
+
+    /**
+     * @brief Get the drones which took off from this server, drawn on it until the collision grid holds them.
+     *
+     * The list may also hold drones which are no more taking off: it is only cleaned at the next take offs.
+     *
+     * @return const QVector<Drone*>& Drones taking off, or recently taken off.
+     */
+    const QVector<Drone*> &getLaunchingDrones() const {
+        return launching;
     }
 
 
@@ -122,15 +179,33 @@ public:
      *
      * @return QVector<Drone*> List of drones.
      */
-    QVector<Drone*> getDrones() const {
+    const QVector<Drone*> &getDrones() const {
         return drones;
     }
 private:
+    /**
+     * @brief Add a drone to the drones taking off, and drop the ones which finished when the list doubled.
+     */
+    void addLaunch(Drone* drone) {
+        if (launching.size() >= launchingCleanSize) {
+            int kept = 0;
+            for (Drone *d : launching) {
+                if (d->getStatus() == Drone::takeoff) launching[kept++] = d;
+            }
+            launching.resize(kept);
+            launchingCleanSize = qMax(16, 2 * kept);
+        }
+        launching.append(drone);
+    }
+
     QString name;                 ///< Name of the server
     Vector2D position;            ///< Position of the server
     QList<Server*> neighbors;///< List of neighboring servers
     QPointF location;///< 2D location of the server
     QVector<Drone*> drones; ///< List of drones managed by this server
+    int landedCount = 0; ///< Number of landed drones in drones, updated on take off and landing
+    QVector<Drone*> launching; ///< Drones which took off from this server, cleaned when its size reaches launchingCleanSize
+    int launchingCleanSize = 16; ///< Size of launching starting its next cleaning
 
 };
 
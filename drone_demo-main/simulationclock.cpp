@@ -0,0 +1,25 @@
+#include "simulationclock.h"
+
+void SimulationClock::reset(qint64 nowMs) {
+    accumulator=0;
+    last=nowMs;
+    stepCount=0;
+    droppedSteps=0;
+}
+
+int SimulationClock::advance(qint64 nowMs) {
+    if (last<0) last=nowMs;
+    accumulator+=(nowMs-last)/1000.0;
+    last=nowMs;
+
+    int steps=int(accumulator/fixedDt);
+    accumulator-=steps*fixedDt;
+    if (accumulator<0) accumulator=0; // rounding error
+    if (steps>maxSteps) {
+        // too late: drop the steps that cannot be run in this tick
+        droppedSteps+=steps-maxSteps;
+        steps=maxSteps;
+    }
+    stepCount+=steps;
+    return steps;
+}
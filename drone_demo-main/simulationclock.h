@@ -0,0 +1,80 @@
+/**
+ * @file simulationclock.h
+ * @brief Fixed time step clock driving the simulation from the wall clock.
+ */
+#ifndef SIMULATIONCLOCK_H
+#define SIMULATIONCLOCK_H
+
+#include <QtGlobal>
+
+/**
+ * @class SimulationClock
+ * @brief The SimulationClock class converts elapsed wall clock time into fixed simulation steps.
+ *
+ * The elapsed time is added to an accumulator which is consumed by steps of fixedDt seconds,
+ * so the simulation does not depend on the load of the machine. When the simulation is late,
+ * at most maxSteps steps are run in one tick and the remaining time is dropped. The fraction of
+ * step left in the accumulator is used to interpolate the drawing between two states.
+ */
+class SimulationClock {
+public:
+    /**
+     * @brief Constructs a clock
+     * @param p_fixedDt duration of a simulation step (s)
+     * @param p_maxSteps maximum number of steps run in one tick
+     */
+    explicit SimulationClock(double p_fixedDt=0.02,int p_maxSteps=10)
+        : fixedDt(p_fixedDt),maxSteps(p_maxSteps) {}
+
+    /**
+     * @brief Restart the clock
+     * @param nowMs current wall clock time (ms)
+     */
+    void reset(qint64 nowMs);
+    /**
+     * @brief Add the time elapsed since the last call to the accumulator
+     * @param nowMs current wall clock time (ms)
+     * @return the number of steps of fixedDt to run now
+     */
+    int advance(qint64 nowMs);
+
+    /**
+     * @brief Get the duration of a simulation step (s)
+     */
+    inline double getFixedDt() const { return fixedDt; }
+    /**
+     * @brief Get the fraction of step waiting in the accumulator, in [0,1[
+     */
+    inline double getAlpha() const { return accumulator/fixedDt; }
+    /**
+     * @brief Get the fraction of step simulated at a later time without running the next step, in [0,1]
+     * @param nowMs current wall clock time (ms)
+     */
+    inline double getAlphaAt(qint64 nowMs) const {
+        if (last<0) return 0;
+        const double alpha=(accumulator+(nowMs-last)/1000.0)/fixedDt;
+        return alpha<1?alpha:1;
+    }
+    /**
+     * @brief Get the simulated time (s), i.e. the number of steps times fixedDt
+     */
+    inline double getTime() const { return double(stepCount)*fixedDt; }
+    /**
+     * @brief Get the number of steps run since the reset
+     */
+    inline qint64 getStepCount() const { return stepCount; }
+    /**
+     * @brief Get the number of steps skipped because the simulation was late
+     */
+    inline qint64 getDroppedSteps() const { return droppedSteps; }
+
+private:
+    double fixedDt;         ///< duration of a simulation step (s)
+    int maxSteps;           ///< maximum number of steps run in one tick
+    double accumulator=0;   ///< wall clock time not simulated yet (s)
+    qint64 last=-1;         ///< wall clock time of the last call (ms), -1 before the first one
+    qint64 stepCount=0;     ///< number of steps run
+    qint64 droppedSteps=0;  ///< number of steps skipped
+};
+
+#endif // SIMULATIONCLOCK_H
@@ -0,0 +1,48 @@
+#include "spatialgrid.h"
+
+void SpatialGrid::setCellSize(float s) {
+    if (s!=cellSize) {
+        cellSize=s;
+        clear();
+    }
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    cellOf.clear();
+    slotOf.clear();
+    count=0;
+}
+
+void SpatialGrid::update(int i,float x,float y) {
+    if (i>=cellOf.size()) {
+        cellOf.resize(i+1,0);
+        slotOf.resize(i+1,-1);
+    }
+    const quint64 key=keyOf(x,y);
+    if (slotOf[i]>=0 && cellOf[i]==key) return; // still in the same cell
+
+    remove(i);
+    QVector<int> &c=cells[key];
+    slotOf[i]=c.size();
+    c.append(i);
+    cellOf[i]=key;
+    count++;
+}
+
+void SpatialGrid::remove(int i) {
+    if (!contains(i)) return;
+
+    auto it=cells.find(cellOf[i]);
+    QVector<int> &c=it.value();
+    // move the last point of the cell at the place of i
+    const int last=c.last();
+    c[slotOf[i]]=last;
+    slotOf[last]=slotOf[i];
+    c.removeLast();
+    if (c.isEmpty()) {
+        cells.erase(it);
+    }
+    slotOf[i]=-1;
+    count--;
+}
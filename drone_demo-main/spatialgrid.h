@@ -0,0 +1,113 @@
+/**
+ * @file spatialgrid.h
+ * @brief Uniform grid used as a broad phase for the collision detection between drones.
+ */
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <QVector>
+#include <QHash>
+#include <cmath>
+
+/**
+ * @class SpatialGrid
+ * @brief The SpatialGrid class sorts indexed points into square cells of a uniform grid.
+ *
+ * Only the non-empty cells are stored, in a hash table keyed on the cell coordinates.
+ * The grid is maintained incrementally: moving a point only touches its old and new cells
+ * when it crosses a cell border. With a cell size equal to the collision distance, all
+ * the points closer than this distance from a point are in the 3x3 block of cells around it.
+ */
+class SpatialGrid {
+public:
+    /**
+     * @brief Constructs an empty grid
+     * @param p_cellSize size of the side of a cell
+     */
+    explicit SpatialGrid(float p_cellSize=1.0f) : cellSize(p_cellSize) {}
+
+    /**
+     * @brief Change the size of the cells, the grid is emptied if the size changes
+     * @param s new size of the side of a cell
+     */
+    void setCellSize(float s);
+    inline float getCellSize() const { return cellSize; }
+
+    /**
+     * @brief Remove all the points
+     */
+    void clear();
+
+    /**
+     * @brief Insert or move the point i at position (x,y)
+     */
+    void update(int i,float x,float y);
+    /**
+     * @brief Remove the point i from the grid (nothing is done if it is not in the grid)
+     */
+    void remove(int i);
+    /**
+     * @brief Check if the point i is stored in the grid
+     */
+    inline bool contains(int i) const { return i<slotOf.size() && slotOf[i]>=0; }
+
+    /**
+     * @brief Get the key of the cell containing the position (x,y)
+     */
+    inline quint64 keyOf(float x,float y) const {
+        return makeKey(int(std::floor(x/cellSize)),int(std::floor(y/cellSize)));
+    }
+    /**
+     * @brief Build the key of the cell at column cx, row cy
+     */
+    static inline quint64 makeKey(int cx,int cy) {
+        return (quint64(quint32(cx))<<32) | quint64(quint32(cy));
+    }
+    static inline int keyX(quint64 key) { return int(quint32(key>>32)); }
+    static inline int keyY(quint64 key) { return int(quint32(key)); }
+
+    /**
+     * @brief Get the indices of the points stored in a cell
+     * @param key key of the cell
+     * @return pointer to the list of points, nullptr if the cell is empty
+     */
+    inline const QVector<int> *cell(quint64 key) const {
+        auto it=cells.find(key);
+        return it==cells.end()?nullptr:&it.value();
+    }
+
+    /**
+     * @brief Call f(j) for every point j stored in the 3x3 cells around the position (x,y)
+     */
+    template <typename F>
+    void forEachNeighbor(float x,float y,F f) const {
+        const int cx=int(std::floor(x/cellSize));
+        const int cy=int(std::floor(y/cellSize));
+        for (int dy=-1; dy<=1; dy++) {
+            for (int dx=-1; dx<=1; dx++) {
+                const QVector<int> *c=cell(makeKey(cx+dx,cy+dy));
+                if (c) {
+                    for (int j:*c) f(j);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Get the cells of the grid
+     */
+    inline const QHash<quint64,QVector<int>> &getCells() const { return cells; }
+    /**
+     * @brief Get the number of points stored in the grid
+     */
+    inline int getCount() const { return count; }
+
+private:
+    float cellSize;                       ///< size of the side of a cell
+    QHash<quint64,QVector<int>> cells;    ///< indices of the points in each non-empty cell
+    QVector<quint64> cellOf;              ///< key of the cell of each point
+    QVector<int> slotOf;                  ///< position of each point in the list of its cell (-1 if absent)
+    int count=0;                          ///< number of points in the grid
+};
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,34 @@
+#include "spriteatlas.h"
+#include <cmath>
+
+void SpriteAtlas::build(const QImage &img,int size,int p_angleCount) {
+    angleCount=qMax(1,p_angleCount);
+    cells.clear();
+    if (img.isNull()) {
+        atlas=QPixmap();
+        return;
+    }
+
+    // a cell contains the sprite whatever its rotation
+    const int cell=int(std::ceil(size*M_SQRT2))+2;
+    const int columns=int(std::ceil(std::sqrt(double(angleCount))));
+    const int rows=(angleCount+columns-1)/columns;
+    QImage sheet(columns*cell,rows*cell,QImage::Format_ARGB32_Premultiplied);
+    sheet.fill(Qt::transparent);
+
+    QPainter painter(&sheet);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const QRectF rectIcon(-size/2.0,-size/2.0,size,size);
+    for (int k=0; k<angleCount; k++) {
+        const QRectF r((k%columns)*cell,(k/columns)*cell,cell,cell);
+        painter.save();
+        painter.translate(r.center());
+        painter.rotate(360.0*k/angleCount);
+        painter.drawImage(rectIcon,img);
+        painter.restore();
+        cells.append(r);
+    }
+    painter.end();
+    atlas=QPixmap::fromImage(sheet);
+}
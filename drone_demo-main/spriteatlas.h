@@ -0,0 +1,61 @@
+/**
+ * @file spriteatlas.h
+ * @brief Pixmap holding an image pre-rotated at regularly spaced angles.
+ */
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+#include <QImage>
+#include <QPainter>
+#include <QPixmap>
+#include <QVector>
+
+/**
+ * @class SpriteAtlas
+ * @brief The SpriteAtlas class stores the rotations of a sprite in a grid of cells of a single pixmap.
+ *
+ * The sprites are drawn with QPainter::drawPixmapFragments as untransformed blits of the cell
+ * of the nearest angle, so a whole fleet is drawn in one call instead of a rotated image per drone.
+ */
+class SpriteAtlas {
+public:
+    SpriteAtlas() {}
+
+    /**
+     * @brief Draw the rotations of an image in the atlas
+     * @param img sprite, drawn centered
+     * @param size size of the sprite (pixels)
+     * @param p_angleCount number of angles, regularly spaced on 360 degrees
+     */
+    void build(const QImage &img,int size,int p_angleCount=64);
+    inline bool isNull() const { return atlas.isNull(); }
+
+    /**
+     * @brief Get the index of the cell of the angle nearest to azimut
+     * @param azimut rotation angle (degree), clockwise as QPainter::rotate
+     */
+    inline int angleIndex(double azimut) const {
+        int k=qRound(azimut*angleCount/360.0)%angleCount;
+        return k<0?k+angleCount:k;
+    }
+    /**
+     * @brief Get the fragment drawing the sprite rotated of azimut centered on a point
+     */
+    inline QPainter::PixmapFragment fragment(const QPointF &center,double azimut) const {
+        const QRectF &src=cells[angleIndex(azimut)];
+        return QPainter::PixmapFragment::create(center,src);
+    }
+    /**
+     * @brief Draw a list of fragments from the atlas
+     */
+    inline void draw(QPainter &painter,const QVector<QPainter::PixmapFragment> &fragments) const {
+        if (!fragments.isEmpty()) painter.drawPixmapFragments(fragments.constData(),fragments.size(),atlas);
+    }
+
+private:
+    QPixmap atlas;        ///< all the rotations of the sprite
+    QVector<QRectF> cells; ///< cell of each angle in atlas
+    int angleCount=1;     ///< number of angles
+};
+
+#endif // SPRITEATLAS_H
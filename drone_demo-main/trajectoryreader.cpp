@@ -0,0 +1,154 @@
+#include "trajectoryreader.h"
+#include <cstring>
+
+bool TrajectoryReader::open(const QString &path) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    size=file.size();
+    if (size<qint64(sizeof(TrajectoryHeader)) || !(data=file.map(0,size))) {
+        close();
+        return false;
+    }
+
+    TrajectoryHeader header;
+    memcpy(&header,data,sizeof(header));
+    if (memcmp(header.magic,TrajectoryHeader::signature,sizeof(header.magic))!=0
+        || header.version!=TrajectoryHeader::currentVersion
+        || qint64(sizeof(header))+header.namesSize>size) {
+        close();
+        return false;
+    }
+    // each name takes at least its length, and the first keyframe holds a sample per drone
+    const qint64 droneCount=header.droneCount;
+    if (2*droneCount>header.namesSize || header.namesSize>droneCount*(2+0xFFFF)) {
+        close();
+        return false;
+    }
+    dt=header.dt;
+
+    // name table, which must end exactly at namesSize
+    const uchar *p=data+sizeof(header);
+    const uchar *namesEnd=p+header.namesSize;
+    names.reserve(int(droneCount));
+    for (qint64 i=0; i<droneCount; i++) {
+        quint16 length=0;
+        if (p+sizeof(length)<=namesEnd) {
+            memcpy(&length,p,sizeof(length));
+            p+=sizeof(length);
+        }
+        if (p+length>namesEnd) break;
+        names.append(QString::fromUtf8(reinterpret_cast<const char*>(p),length));
+        p+=length;
+    }
+    if (names.size()!=droneCount || p!=namesEnd) {
+        close();
+        return false;
+    }
+
+    // index of the complete chunks
+    qint64 offset=namesEnd-data;
+    while (offset+qint64(sizeof(TrajectoryChunk))<=size) {
+        TrajectoryChunk chunk;
+        memcpy(&chunk,data+offset,sizeof(chunk));
+        const qint64 next=offset+qint64(sizeof(chunk))+chunk.size;
+        if (chunk.tick!=quint32(chunks.size()) || next>size) break;
+        if (chunks.isEmpty() && (chunk.type!=TrajectoryChunk::keyframe || chunk.size!=droneCount*sizeof(TrajectorySample))) {
+            close();
+            return false;
+        }
+        chunks.append(offset);
+        offset=next;
+    }
+
+    state.resize(int(droneCount));
+    sampleTick.resize(int(droneCount));
+    if (!chunks.isEmpty()) seek(0);
+    return true;
+}
+
+void TrajectoryReader::close() {
+    if (data) file.unmap(data);
+    data=nullptr;
+    size=0;
+    if (file.isOpen()) file.close();
+    names.clear();
+    chunks.clear();
+    state.clear();
+    sampleTick.clear();
+    tick=-1;
+}
+
+bool TrajectoryReader::apply(int t) {
+    using namespace TrajectoryCodec;
+    TrajectoryChunk chunk;
+    memcpy(&chunk,data+chunks[t],sizeof(chunk));
+    const uchar *p=data+chunks[t]+sizeof(chunk);
+    const uchar *end=p+chunk.size;
+
+    if (chunk.type==TrajectoryChunk::keyframe) {
+        if (chunk.size!=quint32(state.size())*sizeof(TrajectorySample)) return false;
+        memcpy(state.data(),p,chunk.size);
+        sampleTick.fill(t);
+        return true;
+    }
+
+    // every read is checked against the end of the chunk: a corrupted chunk fails instead of reading outside
+    auto field=[&](quint32 &v) { return getVarint(p,end,v); };
+    auto byte=[&](quint8 &v) {
+        if (p>=end) return false;
+        v=*p++;
+        return true;
+    };
+    int i=-1;
+    while (p<end) {
+        quint32 gap,dx,dy,v;
+        quint8 fields;
+        if (!field(gap) || gap>=quint32(state.size()-i-1)) return false;
+        i+=int(gap)+1;
+        sampleTick[i]=t;
+        TrajectorySample &s=state[i];
+        if (!byte(fields)) return false;
+        if (fields&TrajectorySample::positionField) {
+            if (!field(dx) || !field(dy)) return false;
+            s.x=qint32(quint32(s.x)+quint32(unzigzag(dx)));
+            s.y=qint32(quint32(s.y)+quint32(unzigzag(dy)));
+        }
+        if (fields&TrajectorySample::powerField) {
+            if (!field(v)) return false;
+            s.power=quint16(quint32(s.power)+quint32(unzigzag(v)));
+        }
+        if (fields&TrajectorySample::azimutField) {
+            if (!field(v)) return false;
+            s.azimut=quint16(quint32(s.azimut)+quint32(unzigzag(v)));
+        }
+        if ((fields&TrajectorySample::statusField) && !byte(s.status)) return false;
+        if ((fields&TrajectorySample::collisionField) && !byte(s.collision)) return false;
+    }
+    return true;
+}
+
+bool TrajectoryReader::seek(int t) {
+    if (!data || t<0 || t>=chunks.size()) return false;
+    if (t==tick) return true;
+
+    // previous keyframe
+    int first=t;
+    TrajectoryChunk chunk;
+    for (;;) {
+        memcpy(&chunk,data+chunks[first],sizeof(chunk));
+        if (chunk.type==TrajectoryChunk::keyframe || first==0) break;
+        first--;
+    }
+    // continue from the current step when it is between the keyframe and t
+    if (tick>=first && tick<t) first=tick+1;
+
+    for (int k=first; k<=t; k++) {
+        if (!apply(k)) {
+            tick=-1;
+            return false;
+        }
+    }
+    tick=t;
+    return true;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file trajectoryreader.h
+ * @brief Random access to the steps of a trajectory file.
+ */
+#ifndef TRAJECTORYREADER_H
+#define TRAJECTORYREADER_H
+
+#include <QFile>
+#include <QVector>
+#include <QString>
+#include "trajectoryrecorder.h"
+
+/**
+ * @class TrajectoryReader
+ * @brief The TrajectoryReader class maps a trajectory file in memory and restores the fleet state of any step.
+ *
+ * The chunks are indexed when the file is opened, without decoding them. Seeking to a step
+ * decodes the chunks from the previous keyframe, or from the current step when it is closer,
+ * so a seek costs at most one keyframe interval whatever the length of the recording.
+ * An incomplete last chunk (file still being written) is ignored. Every read of a chunk is checked
+ * against its end: a corrupted chunk makes seek() fail instead of reading outside the mapping.
+ */
+class TrajectoryReader : public DroneModel {
+public:
+    TrajectoryReader() {}
+    ~TrajectoryReader() { close(); }
+
+    /**
+     * @brief Map a trajectory file and go to its first step
+     * @param path path of the file
+     * @return false if the file cannot be mapped or is not a trajectory file, or if its number of drones
+     * does not match its name table and its first keyframe
+     */
+    bool open(const QString &path);
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+    inline bool isOpen() const { return data!=nullptr; }
+
+    inline int getDroneCount() const { return state.size(); }
+    inline int getTickCount() const { return chunks.size(); }
+    inline double getDt() const { return dt; }
+    /**
+     * @brief Get the index of the restored step, -1 if none
+     */
+    inline int getTick() const { return tick; }
+    inline const QString &getName(int i) const { return names[i]; }
+
+    /**
+     * @brief Restore the state of the fleet after the step t
+     * @return false if t is not a recorded step
+     */
+    bool seek(int t);
+
+    inline Vector2D getPosition(int i) const {
+        return Vector2D(state[i].x/TrajectorySample::positionScale,state[i].y/TrajectorySample::positionScale);
+    }
+    inline droneStatus getStatus(int i) const { return droneStatus(state[i].status); }
+    /**
+     * @brief get the raw power of the drone i (between 0 and maxPower)
+     *
+     * A landed drone is charging since its last record.
+     */
+    inline double getRawPower(int i) const {
+        const double p=state[i].power/TrajectorySample::powerScale;
+        if (state[i].status!=landed) return p;
+        return qMin(maxPower,p+(tick-sampleTick[i])*dt*chargingSpeed);
+    }
+    /**
+     * @brief get the Power rank of the drone i between 0 and 100
+     */
+    inline double getPower(int i) const { return 100.0*getRawPower(i)/maxPower; }
+    inline double getAzimut(int i) const { return state[i].azimut/TrajectorySample::azimutScale; }
+    inline bool hasCollision(int i) const { return state[i].collision!=0; }
+
+private:
+    /**
+     * @brief Apply the chunk of the step t to the current state
+     * @return false if the chunk is corrupted
+     */
+    bool apply(int t);
+
+    QFile file;                     ///< mapped file
+    uchar *data=nullptr;            ///< first byte of the mapping
+    qint64 size=0;                  ///< size of the mapping
+    double dt=0;                    ///< duration of a step (s)
+    QVector<QString> names;         ///< names of the drones
+    QVector<qint64> chunks;         ///< offset of the chunk of each step
+    QVector<TrajectorySample> state; ///< samples of the restored step
+    QVector<int> sampleTick;        ///< step of the last record of each drone
+    int tick=-1;                    ///< index of the restored step
+};
+
+#endif // TRAJECTORYREADER_H
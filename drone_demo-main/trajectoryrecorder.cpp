@@ -0,0 +1,124 @@
+#include "trajectoryrecorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+
+bool TrajectoryRecorder::open(const QString &path,const DroneFleet &fleet,double dt,int p_keyframeInterval) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+
+    QByteArray names;
+    for (int i=0; i<fleet.size(); i++) {
+        const QByteArray name=fleet.getName(i).toUtf8().left(0xFFFF);
+        const quint16 length=quint16(name.size());
+        names.append(reinterpret_cast<const char*>(&length),sizeof(length));
+        names.append(name);
+    }
+
+    TrajectoryHeader header;
+    memcpy(header.magic,TrajectoryHeader::signature,sizeof(header.magic));
+    header.version=TrajectoryHeader::currentVersion;
+    header.droneCount=quint32(fleet.size());
+    header.dt=dt;
+    header.keyframeInterval=quint32(qMax(1,p_keyframeInterval));
+    header.namesSize=quint32(names.size());
+    file.write(reinterpret_cast<const char*>(&header),sizeof(header));
+    file.write(names);
+
+    keyframeInterval=int(header.keyframeInterval);
+    tick=0;
+    bytesWritten=qint64(sizeof(header))+names.size();
+    last.resize(fleet.size());
+    previousActive.clear();
+    groundRevision=fleet.getGroundRevision();
+    return true;
+}
+
+void TrajectoryRecorder::close() {
+    if (file.isOpen()) file.close();
+}
+
+TrajectorySample TrajectoryRecorder::sample(const DroneFleet &fleet,int i) {
+    TrajectorySample s;
+    const Vector2D p=fleet.getPosition(i);
+    s.x=qint32(std::lround(p.x*TrajectorySample::positionScale));
+    s.y=qint32(std::lround(p.y*TrajectorySample::positionScale));
+    s.power=quint16(std::lround(qMax(0.0,fleet.getRawPower(i))*TrajectorySample::powerScale));
+    // the angle wraps around 65536
+    s.azimut=quint16(qint32(std::lround(fleet.getAzimut(i)*TrajectorySample::azimutScale)));
+    s.status=quint8(fleet.getStatus(i));
+    s.collision=fleet.hasCollision(i)?1:0;
+    s.reserved=0;
+    return s;
+}
+
+void TrajectoryRecorder::encodeDelta(const DroneFleet &fleet) {
+    using namespace TrajectoryCodec;
+    int previous=-1;
+    for (int i:candidates) {
+        const TrajectorySample b=sample(fleet,i);
+        TrajectorySample &a=last[i];
+        quint8 fields=0;
+        if (a.x!=b.x || a.y!=b.y) fields|=TrajectorySample::positionField;
+        if (a.power!=b.power) fields|=TrajectorySample::powerField;
+        if (a.azimut!=b.azimut) fields|=TrajectorySample::azimutField;
+        if (a.status!=b.status) fields|=TrajectorySample::statusField;
+        if (a.collision!=b.collision) fields|=TrajectorySample::collisionField;
+        if (!fields) continue;
+
+        putVarint(buffer,quint32(i-previous-1));
+        previous=i;
+        buffer.append(char(fields));
+        if (fields&TrajectorySample::positionField) {
+            putVarint(buffer,zigzag(b.x-a.x));
+            putVarint(buffer,zigzag(b.y-a.y));
+        }
+        if (fields&TrajectorySample::powerField) putVarint(buffer,zigzag(qint32(b.power)-qint32(a.power)));
+        if (fields&TrajectorySample::azimutField) putVarint(buffer,zigzag(qint16(quint16(b.azimut-a.azimut))));
+        if (fields&TrajectorySample::statusField) buffer.append(char(b.status));
+        if (fields&TrajectorySample::collisionField) buffer.append(char(b.collision));
+        a=b;
+    }
+}
+
+void TrajectoryRecorder::writeChunk(quint32 type) {
+    TrajectoryChunk chunk;
+    chunk.tick=quint32(tick);
+    chunk.type=type;
+    chunk.size=quint32(buffer.size());
+    file.write(reinterpret_cast<const char*>(&chunk),sizeof(chunk));
+    file.write(buffer);
+    bytesWritten+=qint64(sizeof(chunk))+buffer.size();
+}
+
+void TrajectoryRecorder::record(const DroneFleet &fleet) {
+    if (!file.isOpen() || fleet.size()!=last.size()) return;
+
+    // drones out of the ground, sorted: they are usually started in the order of their indices
+    active=fleet.getActiveDrones();
+    if (!std::is_sorted(active.begin(),active.end())) std::sort(active.begin(),active.end());
+    buffer.clear();
+    if (tick%keyframeInterval==0) {
+        for (int i=0; i<last.size(); i++) {
+            last[i]=sample(fleet,i);
+        }
+        buffer.append(reinterpret_cast<const char*>(last.constData()),last.size()*int(sizeof(TrajectorySample)));
+        writeChunk(TrajectoryChunk::keyframe);
+    } else {
+        // the drones out of the ground, and those which landed since the previous step
+        candidates.clear();
+        if (fleet.getGroundRevision()!=groundRevision) {
+            for (int i=0; i<last.size(); i++) candidates.append(i);
+        } else {
+            std::set_union(previousActive.begin(),previousActive.end(),active.begin(),active.end(),std::back_inserter(candidates));
+            candidates.erase(std::unique(candidates.begin(),candidates.end()),candidates.end());
+        }
+        encodeDelta(fleet);
+        writeChunk(TrajectoryChunk::delta);
+    }
+    previousActive.swap(active);
+    groundRevision=fleet.getGroundRevision();
+    tick++;
+}
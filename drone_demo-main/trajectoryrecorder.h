@@ -0,0 +1,176 @@
+/**
+ * @file trajectoryrecorder.h
+ * @brief Binary log of the state of the fleet at each simulation step.
+ *
+ * File layout (little endian):
+ * - a TrajectoryHeader,
+ * - the names of the drones: for each drone, its length in bytes (quint16) then its UTF-8 characters,
+ * - one chunk per step: a TrajectoryChunk followed by its payload.
+ *
+ * The payload of a keyframe chunk is the array of the TrajectorySample of all the drones.
+ * The payload of a delta chunk lists the drones whose sample changed since the previous step:
+ * for each of them, the gap with the index of the previous listed drone (varint), a byte of
+ * TrajectorySample::Field flags, then the zigzag varint differences of the changed fields.
+ * A keyframe is written every keyframeInterval steps, so a reader can restore any step by
+ * decoding at most keyframeInterval chunks.
+ *
+ * Between two keyframes, a landed drone is only listed when it lands or is moved: its power,
+ * charging at DroneModel::chargingSpeed, is extrapolated by the reader from its last record.
+ */
+#ifndef TRAJECTORYRECORDER_H
+#define TRAJECTORYRECORDER_H
+
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+#include "dronefleet.h"
+
+/**
+ * @brief Fixed header of a trajectory file
+ */
+struct TrajectoryHeader {
+    static constexpr char signature[8]={'D','R','N','T','R','A','J','\0'};
+    static constexpr quint32 currentVersion=1;
+
+    char magic[8];            ///< signature of the file
+    quint32 version;          ///< version of the format
+    quint32 droneCount;       ///< number of drones of every step
+    double dt;                ///< duration of a step (s)
+    quint32 keyframeInterval; ///< number of steps between two keyframes
+    quint32 namesSize;        ///< size of the name table following the header (bytes)
+};
+
+/**
+ * @brief Header of the record of one step
+ */
+struct TrajectoryChunk {
+    enum chunkType { keyframe=1,delta=2 };
+
+    quint32 tick; ///< index of the step
+    quint32 type; ///< chunkType
+    quint32 size; ///< size of the payload (bytes)
+};
+
+/**
+ * @brief Quantized state of a drone
+ */
+struct TrajectorySample {
+    static constexpr float positionScale=16;      ///< units per pixel
+    static constexpr float powerScale=100;        ///< units per power point
+    static constexpr float azimutScale=65536/360.0f; ///< units per degree
+    enum Field { positionField=1,powerField=2,azimutField=4,statusField=8,collisionField=16 };
+
+    qint32 x,y;        ///< position
+    quint16 power;     ///< raw power
+    quint16 azimut;    ///< rotation angle, modulo 360 degrees
+    quint8 status;     ///< droneStatus
+    quint8 collision;  ///< 1 if a collision is detected
+    quint16 reserved;  ///< padding, always 0
+};
+
+/**
+ * @brief Variable length encoding of the integers of the delta chunks
+ */
+namespace TrajectoryCodec {
+    /**
+     * @brief Append an unsigned integer, 7 bits per byte
+     */
+    inline void putVarint(QByteArray &out,quint32 v) {
+        while (v>=0x80) {
+            out.append(char(v|0x80));
+            v>>=7;
+        }
+        out.append(char(v));
+    }
+    /**
+     * @brief Read an unsigned integer and move p after it
+     * @param end end of the buffer, never read
+     * @return false if the integer is truncated or longer than 5 bytes
+     */
+    inline bool getVarint(const uchar *&p,const uchar *end,quint32 &v) {
+        v=0;
+        for (int shift=0; shift<=28; shift+=7) {
+            if (p>=end) return false;
+            const uchar b=*p++;
+            v|=quint32(b&0x7F)<<shift;
+            if (!(b&0x80)) return true;
+        }
+        return false;
+    }
+    /**
+     * @brief Map a signed integer on an unsigned one, the small values staying small
+     */
+    inline quint32 zigzag(qint32 v) { return (quint32(v)<<1)^quint32(v>>31); }
+    inline qint32 unzigzag(quint32 v) { return qint32(v>>1)^-qint32(v&1); }
+}
+
+/**
+ * @class TrajectoryRecorder
+ * @brief The TrajectoryRecorder class appends the state of a fleet to a trajectory file after each step.
+ *
+ * The drones are quantized, compared with the previous step and only the changes are written.
+ * Only the drones out of the ground, and those which were at the previous step, are compared:
+ * the landed drones are only sampled by the keyframes, so a step costs O(active drones) plus
+ * O(drones) once per keyframe interval.
+ */
+class TrajectoryRecorder {
+public:
+    TrajectoryRecorder() {}
+    ~TrajectoryRecorder() { close(); }
+
+    /**
+     * @brief Create the file and write its header
+     * @param path path of the file
+     * @param fleet recorded fleet, whose number of drones must not change until close()
+     * @param dt duration of a step (s)
+     * @param p_keyframeInterval number of steps between two keyframes
+     * @return false if the file cannot be created
+     */
+    bool open(const QString &path,const DroneFleet &fleet,double dt,int p_keyframeInterval=100);
+    /**
+     * @brief Append the current state of the fleet as a new step
+     */
+    void record(const DroneFleet &fleet);
+    /**
+     * @brief Close the file
+     */
+    void close();
+
+    inline bool isOpen() const { return file.isOpen(); }
+    /**
+     * @brief Get the number of recorded steps
+     */
+    inline int getTickCount() const { return tick; }
+    /**
+     * @brief Get the size of the file (bytes)
+     */
+    inline qint64 getBytesWritten() const { return bytesWritten; }
+
+    /**
+     * @brief Quantize the state of the drone i of a fleet
+     */
+    static TrajectorySample sample(const DroneFleet &fleet,int i);
+
+private:
+    /**
+     * @brief Encode the changes of the drones of candidates in buffer and update their last sample
+     */
+    void encodeDelta(const DroneFleet &fleet);
+    /**
+     * @brief Write a chunk whose payload is in buffer
+     */
+    void writeChunk(quint32 type);
+
+    QFile file;                      ///< trajectory file
+    int keyframeInterval=100;        ///< number of steps between two keyframes
+    int tick=0;                      ///< index of the next step
+    qint64 bytesWritten=0;           ///< size of the file
+    QVector<TrajectorySample> last;  ///< last written sample of each drone
+    QVector<int> active;             ///< drones out of the ground, sorted
+    QVector<int> previousActive;     ///< drones out of the ground at the previous step, sorted
+    QVector<int> candidates;         ///< drones compared by the current step, sorted
+    quint64 groundRevision=0;        ///< moves of landed drones already recorded
+    QByteArray buffer;               ///< payload of the current chunk
+};
+
+#endif // TRAJECTORYRECORDER_H
@@ -1,12 +1,16 @@
 #include "triangle.h"
+#include "logging.h"
 #include <QThread>
 #include <QPen>
 #include <QPainter>
 #include <QDebug>
+#include <QHash>
 
 //-------------------------------------
 
 QVector<Triangle> Triangle::triangles;
+int Triangle::nonDelaunayCount = 0;
+QVector<int> Triangle::dirtyTriangles;
 
 void Triangle::computeCircle()
 {
@@ -29,9 +33,7 @@ void Triangle::computeCircle()
 //-------------------------------------
 bool Triangle::isOnTheLeft(const Vector2D *P, const Vector2D *P1, const Vector2D *P2)
 {
-    Vector2D AB = *P2 - *P1;
-    Vector2D AP = *P  - *P1;
-    return (AB.x * AP.y - AB.y * AP.x) >= 0;
+    return Predicates::orient2d(*P1, *P2, *P) >= 0;
 }
 
 //-------------------------------------
@@ -43,11 +45,11 @@ bool Triangle::isInside(const Vector2D &P)
     bool left3 = isOnTheLeft(&P, ptr[2], ptr[0]);
 
     // Log the results for debugging
-    qDebug() << "Point:" << P.x << P.y
+    qCDebug(lcGeometry) << "Point:" << P.x << P.y
              << "Left1:" << left1 << "Left2:" << left2 << "Left3:" << left3;
 
     // Return true only if all checks are true
-    qDebug() << "Point is inside the triangle!";
+    qCDebug(lcGeometry) << "Point is inside the triangle!";
 
     return left1 && left2 && left3;  // Point is inside only if all checks pass
 }
@@ -82,38 +84,35 @@ bool Triangle::isOnTheEdge(const Vector2D &P, const Vector2D &A, const Vector2D
     Vector2D AB = B - A;
     Vector2D AP = P - A;
 
-    // Check collinearity using cross product
-    if (std::abs(AB.x * AP.y - AB.y * AP.x) > 1e-6) {
+    // Check collinearity with the exact orientation
+    if (Predicates::orient2d(A, B, P) != 0) {
         return false;
     }
 
     // Check if the point is within the segment
-    float dotProduct = AP.x * AB.x + AP.y * AB.y;
-    float squaredLengthAB = AB.x * AB.x + AB.y * AB.y;
+    double dotProduct = double(AP.x) * AB.x + double(AP.y) * AB.y;
+    double squaredLengthAB = double(AB.x) * AB.x + double(AB.y) * AB.y;
 
     return dotProduct >= 0 && dotProduct <= squaredLengthAB;
 }
 
 //-------------------------------------
-bool Triangle::circleContains(const Vector2D *M){
-    Matrix33 mat;
-    Vector2D *A = ptr[0];
-    Vector2D *B = ptr[1];
-    Vector2D *C = ptr[2];
-
-    mat.m[0][0] = A->x - M->x;
-    mat.m[0][1] = A->y - M->y;
-    mat.m[0][2] = ((A->x * A->x) - (M->x * M->x)) + ((A->y * A->y) - (M->y * M->y));
-
-    mat.m[1][0] = B->x - M->x;
-    mat.m[1][1] = B->y - M->y ;
-    mat.m[1][2] = ((B->x * B->x) - (M->x * M->x)) + ((B->y * B->y) - (M->y * M->y));
+static double orientation(const Vector2D *A, const Vector2D *B, const Vector2D *C)
+{
+    return Predicates::orient2d(*A, *B, *C);
+}
 
-    mat.m[2][0] =   C->x - M->x;
-    mat.m[2][1] =  C->y - M->y ;
-    mat.m[2][2] = ((C->x * C->x) - (M->x * M->x)) + ((C->y * C->y) - (M->y * M->y));
+bool Triangle::isInCircumcircle(const Vector2D *M) const
+{
+    const double det = Predicates::incircle(*ptr[0], *ptr[1], *ptr[2], *M);
+    // the sign of the determinant is reversed for a clockwise triangle
+    return orientation(ptr[0], ptr[1], ptr[2]) > 0 ? det > 0 : det < 0;
+}
 
-    return mat.determinant()<=0;
+//-------------------------------------
+bool Triangle::circleContains(const Vector2D *M){
+    // not strictly inside the circle, for a counterclockwise triangle (y axis up)
+    return Predicates::incircle(*ptr[0], *ptr[1], *ptr[2], *M) <= 0;
 }
 
 //-------------------------------------
@@ -127,8 +126,6 @@ void Triangle::updateVertices(Vector2D* _A, Vector2D* _B, Vector2D* _C){
 }
 
 void Triangle::draw(QPainter &painter) const{
-    qDebug() << "Entered Triangle::draw";
-
     // Set the pen properties
     QPen pen(Qt::black);
     pen.setWidth(3);
@@ -142,34 +139,13 @@ void Triangle::draw(QPainter &painter) const{
         float h, s, l;
         color.getHslF(&h, &s, &l);
         color.setHslF(h, s, l * 0.75f);
-        qDebug() << "Triangle is highlighted. Adjusted color brightness.";
-
-        QVector<const Vector2D*> commonEdges;
-
-
-        for (Triangle &tri : triangles) {
-            // Skip self
-            if (&tri == this) continue;
-
-            // Clear previous common edges
-            commonEdges.clear();
-
-            // Check for a common edge between this triangle and tri
-            for (int i = 0; i < 3; i++) {
-                if (tri.hasEdge(*this->getVertexPtr(i), *this->getVertexPtr((i + 1) % 3))) {
-                    commonEdges.append(this->getVertexPtr(i));
-                    commonEdges.append(this->getVertexPtr((i + 1) % 3));
-                    break;
-                }
-            }
+        qCDebug(lcGeometry) << "Triangle is highlighted. Adjusted color brightness.";
 
-            // If a common edge is found, attempt flipping
-            if (commonEdges.size() == 2) {
-                qDebug() << "Found common edge between triangles: ("
-                         << commonEdges[0]->x << "," << commonEdges[0]->y << ") and ("
-                         << commonEdges[1]->x << "," << commonEdges[1]->y << ")";
-
-    }
+        for (int i = 0; i < 3; i++) {
+            if (neighbor[i] < 0) continue;
+            qCDebug(lcGeometry) << "Neighbor" << neighbor[i] << "across the edge: ("
+                     << ptr[(i + 1) % 3]->x << "," << ptr[(i + 1) % 3]->y << ") and ("
+                     << ptr[(i + 2) % 3]->x << "," << ptr[(i + 2) % 3]->y << ")";
         }
     }
     painter.setBrush(color);
@@ -178,21 +154,19 @@ void Triangle::draw(QPainter &painter) const{
     QPointF points[3];
     for (int i = 0; i < 3; i++) {
         if (!ptr[i]) {
-            qDebug() << "Error: Null pointer encountered for vertex" << i;
+            qCWarning(lcGeometry) << "Error: Null pointer encountered for vertex" << i;
             return;  // Abort drawing if any vertex is null
         }
 
         points[i].setX(ptr[i]->x);
         points[i].setY(ptr[i]->y);
-        qDebug() << "Vertex" << i << ": (" << ptr[i]->x << "," << ptr[i]->y << ")";
     }
 
     // Draw the triangle
     try {
         painter.drawPolygon(points, 3);
-        qDebug() << "Successfully drew triangle.";
     } catch (...) {
-        qDebug() << "Error while drawing triangle.";
+        qCWarning(lcGeometry) << "Error while drawing triangle.";
     }
 }
 
@@ -279,29 +253,11 @@ bool Triangle:: checkDelaunay(const QVector<Vector2D> &tabVertices) {
     bool isOk = true;
 
 
-    // Assume tabVertices has at least three points, A, B, and C
-    // Assume tabVertices has at least three points, A, B, and C
-    const Vector2D *A = ptr[0];
-    const Vector2D *B = ptr[1];
-    const Vector2D *C = ptr[2];
-
+    // strictly inside only: the vertices of the triangle are on the circle
     while (it != tabVertices.end() && isOk) {
-        Matrix33 mat;
         // PAGE 35 DU COURS GEOMETRIC ALGOITHMS
         const Vector2D D = (*it);
-        mat.m[0][0] = A->x - D.x;
-        mat.m[0][1] = A->y - D.y;
-        mat.m[0][2] = ((A->x * A->x) - (D.x * D.x)) + ((A->y * A->y) - (D.y * D.y));
-
-        mat.m[1][0] = B->x - D.x;
-        mat.m[1][1] = B->y - D.y ;
-        mat.m[1][2] = ((B->x * B->x) - (D.x * D.x)) + ((B->y * B->y) - (D.y * D.y));
-
-        mat.m[2][0] =   C->x - D.x;
-        mat.m[2][1] =  C->y - D.y ;
-        mat.m[2][2] = ((C->x * C->x) - (D.x * D.x)) + ((C->y * C->y) - (D.y * D.y));
-
-        isOk = (mat.determinant() <= 0);
+        isOk = !isInCircumcircle(&D);
         it++;
     };
     isDelaunay=isOk;
@@ -317,50 +273,203 @@ Vector2D* Triangle::getOpposite(const QVector<const Vector2D*>& commonEdges) con
             return ptr[i];  // Return the vertex that is not part of the common edge
         }
     }
-    qDebug() << "Error: No opposite point found for the given common edge!";
+    qCWarning(lcGeometry) << "Error: No opposite point found for the given common edge!";
     return nullptr;
 }
 
-void Triangle::flippIt(QVector<Triangle>& triangles) {
-    QVector<const Vector2D*> commonEdges;
+void Triangle::linkBack(QVector<Triangle>& triangles, int t, int i) {
+    Triangle &tri = triangles[t];
+    const int n = tri.neighbor[i];
+    if (n < 0) {
+        tri.neighborSlot[i] = -1;
+        return;
+    }
+    // the vertex of the neighbor which is not on the shared edge
+    Triangle &other = triangles[n];
+    const Vector2D &a = *tri.ptr[(i + 1) % 3];
+    const Vector2D &b = *tri.ptr[(i + 2) % 3];
+    for (int j = 0; j < 3; j++) {
+        if (!(*other.ptr[j] == a) && !(*other.ptr[j] == b)) {
+            other.neighbor[j] = t;
+            other.neighborSlot[j] = qint8(i);
+            tri.neighborSlot[i] = qint8(j);
+            return;
+        }
+    }
+    qCWarning(lcGeometry) << "Error: neighbor" << n << "does not share an edge with triangle" << t;
+}
 
-    for (Triangle& tri : triangles) {
-        if (&tri == this) continue;
+bool Triangle::flipEdge(QVector<Triangle>& triangles, int t, int i) {
+    // t=(p,q,r) and g=(d,..) sharing the edge (q,r) become t=(p,q,d) and g=(d,r,p)
+    const Triangle F = triangles.at(t);
+    const int g = F.neighbor[i];
+    if (g < 0) return false;
+    const Triangle G = triangles.at(g);
+    const int m = F.neighborSlot[i];
+    Vector2D *p = F.ptr[i], *q = F.ptr[(i + 1) % 3], *r = F.ptr[(i + 2) % 3], *d = G.ptr[m];
+    // neighbors of g across (d,q) and (d,r), whatever the orientation of g
+    const int qInG = (*G.ptr[(m + 1) % 3] == *q) ? (m + 1) % 3 : (m + 2) % 3;
+    const int rInG = 3 - m - qInG;
+    const int acrossDQ = G.neighbor[rInG];
+    const int acrossDR = G.neighbor[qInG];
+
+    Triangle &newF = triangles[t];
+    newF.updateVertices(p, q, d);
+    newF.neighbor[0] = acrossDQ;
+    newF.neighbor[1] = g;
+    newF.neighbor[2] = F.neighbor[(i + 2) % 3];
+    newF.computeCircle();
+    Triangle &newG = triangles[g];
+    newG.updateVertices(d, r, p);
+    newG.neighbor[0] = F.neighbor[(i + 1) % 3];
+    newG.neighbor[1] = t;
+    newG.neighbor[2] = acrossDR;
+    newG.computeCircle();
+
+    markDirty(triangles, t);
+    markDirty(triangles, g);
+    for (int k = 0; k < 3; k++) {
+        linkBack(triangles, t, k);
+        linkBack(triangles, g, k);
+        // the outer neighbors face a new opposite vertex
+        if (newF.neighbor[k] >= 0) markDirty(triangles, newF.neighbor[k]);
+        if (newG.neighbor[k] >= 0) markDirty(triangles, newG.neighbor[k]);
+    }
+    return true;
+}
 
-        // Find common edge
-        commonEdges.clear();
-        for (int i = 0; i < 3; ++i) {
-            if (tri.hasEdge(*this->getVertexPtr(i), *this->getVertexPtr((i + 1) % 3))) {
-                commonEdges.append(this->getVertexPtr(i));
-                commonEdges.append(this->getVertexPtr((i + 1) % 3));
-                break;
+void Triangle::buildAdjacency(QVector<Triangle>& triangles) {
+    // the vertices are identified by value, as in hasEdge()
+    QHash<QPair<float, float>, int> vertexId;
+    vertexId.reserve(triangles.size());
+    // edges seen once, with the triangle and the vertex opposite to them
+    QHash<quint64, int> openEdges;
+    openEdges.reserve(triangles.size() * 2);
+    QVector<int> ids(3 * triangles.size());
+    for (int t = 0; t < triangles.size(); t++) {
+        for (int i = 0; i < 3; i++) {
+            const QPair<float, float> key(triangles[t].ptr[i]->x, triangles[t].ptr[i]->y);
+            auto it = vertexId.find(key);
+            if (it == vertexId.end()) it = vertexId.insert(key, vertexId.size());
+            ids[3 * t + i] = it.value();
+            triangles[t].neighbor[i] = -1;
+            triangles[t].neighborSlot[i] = -1;
+        }
+    }
+    for (int t = 0; t < triangles.size(); t++) {
+        for (int i = 0; i < 3; i++) {
+            const quint32 a = ids[3 * t + (i + 1) % 3];
+            const quint32 b = ids[3 * t + (i + 2) % 3];
+            const quint64 edge = (quint64(qMin(a, b)) << 32) | qMax(a, b);
+            auto it = openEdges.find(edge);
+            if (it == openEdges.end()) {
+                openEdges.insert(edge, 3 * t + i);
+                continue;
             }
+            const int u = it.value() / 3, j = it.value() % 3;
+            openEdges.erase(it);
+            triangles[t].neighbor[i] = u;
+            triangles[t].neighborSlot[i] = qint8(j);
+            triangles[u].neighbor[j] = t;
+            triangles[u].neighborSlot[j] = qint8(i);
         }
+    }
+}
 
-        if (commonEdges.size() == 2) {
-            Vector2D* thisOpposite = this->getOpposite(commonEdges);
-            Vector2D* triOpposite = tri.getOpposite(commonEdges);
-
-            if (thisOpposite && triOpposite) {
-                qDebug() << "Performing flip for triangles with opposite points: ("
-                         << thisOpposite->x << "," << thisOpposite->y << ") and ("
-                         << triOpposite->x << "," << triOpposite->y << ")";
-
-                this->updateVertices(thisOpposite, const_cast<Vector2D*>(commonEdges[0]), triOpposite);
-                tri.updateVertices(triOpposite, const_cast<Vector2D*>(commonEdges[1]), thisOpposite);
-
-                this->computeCircle();
-                tri.computeCircle();
-
-                qDebug() << "Flip completed. Updated vertices:";
-                qDebug() << "This triangle: (" << ptr[0]->x << "," << ptr[0]->y << "), ("
-                         << ptr[1]->x << "," << ptr[1]->y << "), (" << ptr[2]->x << "," << ptr[2]->y << ")";
-                return;
-            }
+Triangle::FlipReport Triangle::legalize(QVector<Triangle>& triangles) {
+    // each inner edge once, from the triangle of lower index
+    QVector<int> edges;
+    edges.reserve(3 * triangles.size() / 2 + 3);
+    for (int t = 0; t < triangles.size(); t++) {
+        for (int i = 0; i < 3; i++) {
+            if (triangles[t].neighbor[i] > t) edges.append(3 * t + i);
         }
     }
+    return legalize(triangles, edges);
+}
 
-    qDebug() << "No flip performed for this triangle.";
+Triangle::FlipReport Triangle::legalize(QVector<Triangle>& triangles, const QVector<int>& suspects) {
+    FlipReport report;
+    QVector<quint8> queued(3 * triangles.size(), 0);
+    QVector<int> stack;
+    stack.reserve(suspects.size());
+    auto push = [&](int e) {
+        if (!queued[e]) {
+            queued[e] = 1;
+            stack.append(e);
+        }
+    };
+    for (int e : suspects) push(e);
+
+    // Lawson flips always end with exact predicates, the budget only guards against a corrupted adjacency
+    const qint64 budget = qint64(triangles.size()) * triangles.size() + 1000;
+    while (!stack.isEmpty()) {
+        const int e = stack.takeLast();
+        queued[e] = 0;
+        const int t = e / 3, i = e % 3;
+        const Triangle &tri = triangles.at(t);
+        const int n = tri.neighbor[i];
+        if (n < 0) continue;
+        report.tested++;
+        const Vector2D *d = triangles.at(n).ptr[tri.neighborSlot[i]];
+        if (!tri.isInCircumcircle(d)) continue;
+
+        // the two new triangles must keep the orientation of the old ones
+        const Vector2D *p = tri.ptr[i], *q = tri.ptr[(i + 1) % 3], *r = tri.ptr[(i + 2) % 3];
+        const double o = orientation(p, q, r);
+        if (orientation(p, q, d) * o <= 0 || orientation(d, r, p) * o <= 0) {
+            report.skipped++;
+            continue;
+        }
+        if (report.flipped >= budget) {
+            qCWarning(lcGeometry) << "Flip budget exhausted after" << report.flipped << "flips.";
+            report.delaunay = false;
+            return report;
+        }
+        flipEdge(triangles, t, i);
+        report.flipped++;
+        // t=(p,q,d) and n=(d,r,p): their outer edges are opposite to vertices 0 and 2
+        push(3 * t);
+        push(3 * t + 2);
+        push(3 * n);
+        push(3 * n + 2);
+    }
+    report.delaunay = report.skipped == 0;
+    return report;
 }
 
+void Triangle::resetCertification(QVector<Triangle>& triangles) {
+    dirtyTriangles.resize(triangles.size());
+    for (int t = 0; t < triangles.size(); t++) {
+        triangles[t].isDelaunay = false;
+        triangles[t].flippable = false;
+        triangles[t].dirty = true;
+        dirtyTriangles[t] = t;
+    }
+    nonDelaunayCount = triangles.size();
+}
 
+int Triangle::certify(QVector<Triangle>& triangles) {
+    for (int t : std::as_const(dirtyTriangles)) {
+        Triangle &tri = triangles[t];
+        tri.dirty = false;
+        bool isOk = true;
+        bool canFlip = false;
+        for (int i = 0; i < 3; i++) {
+            const int n = tri.neighbor[i];
+            if (n < 0) continue;
+            const Vector2D *d = triangles.at(n).ptr[tri.neighborSlot[i]];
+            if (!tri.isInCircumcircle(d)) continue;
+            isOk = false;
+            // the edge can be flipped if the quadrilateral is convex
+            const Vector2D *p = tri.ptr[i], *q = tri.ptr[(i + 1) % 3], *r = tri.ptr[(i + 2) % 3];
+            const double o = orientation(p, q, r);
+            if (orientation(p, q, d) * o > 0 && orientation(d, r, p) * o > 0) canFlip = true;
+        }
+        if (isOk != tri.isDelaunay) nonDelaunayCount += isOk ? -1 : 1;
+        tri.isDelaunay = isOk;
+        tri.flippable = canFlip;
+    }
+    dirtyTriangles.clear();
+    return nonDelaunayCount;
+}
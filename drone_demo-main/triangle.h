@@ -8,7 +8,8 @@
 
 #include <QPainter>
 #include <vector2d.h>
-#include "determinant.h"
+#include "predicates.h"
+#include "logging.h"
 #include <QDebug>
 #include <QVector>
 
@@ -45,12 +46,37 @@ private:
      */
     bool      isDelaunay  = false;
 
+    /**
+     * @brief dirty
+     * Whether the triangle changed since its last certification (new triangle, moved vertex or flipped neighbor),
+     * and is queued in dirtyTriangles.
+     */
+    bool      dirty       = true;
+
     /**
      * @brief flippPoint
      * Pointer to a vertex that might be used during flipping logic.
      */
     Vector2D* flippPoint  = nullptr;
 
+    /**
+     * @brief neighbor
+     * Index in the triangle list of the triangle across the edge opposite to each vertex, -1 on the border.
+     */
+    int       neighbor[3] = {-1, -1, -1};
+
+    /**
+     * @brief neighborSlot
+     * Index, in the neighbor across the edge opposite to each vertex, of the vertex opposite to this edge.
+     */
+    qint8     neighborSlot[3] = {-1, -1, -1};
+
+    /**
+     * @brief linkBack
+     * Makes the neighbor across the edge opposite to vertex i of triangles[t] point back to it, and sets the slots.
+     */
+    static void linkBack(QVector<Triangle>& triangles, int t, int i);
+
     /**
      * @brief computeCircle
      * Computes the circumcircle from the three vertices and sets `circumCenter` and `circumRadius`.
@@ -76,12 +102,36 @@ public:
      */
     bool      isHighlited = false;  ///< whether triangle is highlighted
 
+    /**
+     * @brief The FlipReport struct counts the work of a Lawson flip pass.
+     */
+    struct FlipReport {
+        int tested = 0;        ///< edges tested against the vertex opposite to them
+        int flipped = 0;       ///< edges flipped
+        int skipped = 0;       ///< non Delaunay edges left because their quadrilateral is not convex
+        bool delaunay = true;  ///< whether all the edges are Delaunay at the end
+    };
+
     /**
      * @brief triangles
      * A static list containing all triangles.
      */
     static QVector<Triangle> triangles; // Static list of all triangles
 
+    /**
+     * @brief nonDelaunayCount
+     * Number of triangles flagged non Delaunay in the list being certified: maintained by certify(),
+     * set to the number of triangles by resetCertification().
+     */
+    static int nonDelaunayCount;
+
+    /**
+     * @brief dirtyTriangles
+     * Indices of the triangles changed since the last certify() (each once, the dirty flag telling
+     * if it is queued): pushed by markDirty(), drained by certify().
+     */
+    static QVector<int> dirtyTriangles;
+
     /**
      * @brief Constructs a Triangle with three vertices and a specified color.
      * @param v0 Pointer to the first vertex.
@@ -116,7 +166,7 @@ public:
         Triangle::triangles.clear();  // Clear the existing triangles
         Triangle::triangles.reserve(tris.size());  // Optimize memory allocation
 
-        qDebug() << "Setting triangles. Total count:" << tris.size();
+        qCDebug(lcGeometry) << "Setting triangles. Total count:" << tris.size();
         for (const Triangle& incomingTriangle : tris) {
             // Create a new Triangle using the existing vertices
             Triangle newTriangle(
@@ -129,15 +179,126 @@ public:
             // Debug each vertex
             for (int i = 0; i < 3; i++) {
                 if (incomingTriangle.ptr[i]) {
-                    qDebug() << "Vertex" << i << ": (" << incomingTriangle.ptr[i]->x << "," << incomingTriangle.ptr[i]->y << ")";
+                    qCDebug(lcGeometry) << "Vertex" << i << ": (" << incomingTriangle.ptr[i]->x << "," << incomingTriangle.ptr[i]->y << ")";
                 } else {
-                    qDebug() << "Vertex" << i << ": null";
+                    qCDebug(lcGeometry) << "Vertex" << i << ": null";
                 }
             }
 
             // Add the new triangle to the static vector
             Triangle::triangles.append(newTriangle);
         }
+        buildAdjacency(Triangle::triangles);
+        resetCertification(Triangle::triangles);
+    }
+
+    /**
+     * @brief buildAdjacency
+     * Finds the neighbors of all the triangles, the vertices being compared by value. O(T) with a hash of the edges.
+     * @param triangles The triangles to link together.
+     */
+    static void buildAdjacency(QVector<Triangle>& triangles);
+
+    /**
+     * @brief flipEdge
+     * Flips the edge opposite to vertex i of triangles[t] and updates the neighbors of the 2 triangles and around them.
+     * The quadrilateral formed with the neighbor must be convex.
+     * @param triangles The triangle list containing the triangle and its neighbors.
+     * @param t Index of the triangle.
+     * @param i Index of the vertex opposite to the edge.
+     * @return False if there is no neighbor across this edge.
+     */
+    static bool flipEdge(QVector<Triangle>& triangles, int t, int i);
+
+    /**
+     * @brief legalize
+     * Lawson flips of all the edges of the triangles until the triangulation is Delaunay.
+     * @param triangles The triangles, linked by buildAdjacency() or setNeighbor().
+     * @return The number of tests and flips.
+     */
+    static FlipReport legalize(QVector<Triangle>& triangles);
+
+    /**
+     * @brief legalize
+     * Lawson flips starting from a set of suspect edges: each flipped edge queues the four edges around it,
+     * so only the region changed by the flips is visited.
+     * @param triangles The triangles, linked by buildAdjacency() or setNeighbor().
+     * @param suspects Edges to test, encoded as 3 * triangle index + index of the vertex opposite to the edge.
+     * @return The number of tests and flips.
+     */
+    static FlipReport legalize(QVector<Triangle>& triangles, const QVector<int>& suspects);
+
+    /**
+     * @brief certify
+     * Sets the Delaunay and flippable flags of the dirty triangles with a local test: a triangle is Delaunay
+     * when the vertex of each neighbor opposite to the shared edge is not in its circumcircle. A triangulation
+     * whose edges are all locally Delaunay is Delaunay, so only the triangles changed by the last edits are tested.
+     * Only the triangles of dirtyTriangles are visited, and nonDelaunayCount is updated when a flag changes.
+     * @param triangles The triangles, linked by buildAdjacency() or setNeighbor(), and edited since resetCertification().
+     * @return The number of triangles flagged non Delaunay after the certification.
+     */
+    static int certify(QVector<Triangle>& triangles);
+
+    /**
+     * @brief resetCertification
+     * Starts the certification of a new list of triangles: all of them are flagged non Delaunay and dirty.
+     * @param triangles The triangles.
+     */
+    static void resetCertification(QVector<Triangle>& triangles);
+
+    /**
+     * @brief markDirty
+     * Queues a triangle to be tested again by the next certify(), if it is not queued yet.
+     * @param triangles The triangle list.
+     * @param t Index of the triangle.
+     */
+    static inline void markDirty(QVector<Triangle>& triangles, int t)
+    {
+        if (triangles[t].dirty) return;
+        triangles[t].dirty = true;
+        dirtyTriangles.append(t);
+    }
+
+    /**
+     * @brief isDirty
+     * @return True if the triangle changed since its last certification.
+     */
+    inline bool isDirty() const
+    {
+        return dirty;
+    }
+
+    /**
+     * @brief getNeighbor
+     * @param i Index of a vertex (0, 1, or 2).
+     * @return Index in the triangle list of the triangle across the edge opposite to vertex i, -1 on the border.
+     */
+    inline int getNeighbor(int i) const
+    {
+        return neighbor[i];
+    }
+
+    /**
+     * @brief getNeighborSlot
+     * @param i Index of a vertex (0, 1, or 2).
+     * @return Index, in the neighbor across the edge opposite to vertex i, of its vertex opposite to this edge.
+     */
+    inline int getNeighborSlot(int i) const
+    {
+        return neighborSlot[i];
+    }
+
+    /**
+     * @brief setNeighbor
+     * Sets the neighbor across the edge opposite to vertex i, the caller keeps the neighbor consistent.
+     * @param i Index of a vertex (0, 1, or 2).
+     * @param n Index of the neighbor in the triangle list, -1 on the border.
+     * @param slot Index of the opposite vertex in the neighbor.
+     */
+    inline void setNeighbor(int i, int n, int slot)
+    {
+        neighbor[i] = n;
+        neighborSlot[i] = qint8(slot);
     }
 
     /**
@@ -181,7 +342,7 @@ public:
      * @return True if the triangle is marked as flippable.
      */
     bool isFlippable() const {
-        qDebug() << "Checking flippable status for triangle: ("
+        qCDebug(lcGeometry) << "Checking flippable status for triangle: ("
                  << ptr[0]->x << "," << ptr[0]->y << "), ("
                  << ptr[1]->x << "," << ptr[1]->y << "), ("
                  << ptr[2]->x << "," << ptr[2]->y << ")";
@@ -196,9 +357,9 @@ public:
     inline void setOpposite(Vector2D* o)
     {
         if (o) {
-            qDebug() << "Setting opposite point:" << o->x << o->y;
+            qCDebug(lcGeometry) << "Setting opposite point:" << o->x << o->y;
         } else {
-            qDebug() << "Setting opposite point: nullptr";
+            qCDebug(lcGeometry) << "Setting opposite point: nullptr";
         }
         flippPoint = o;
     }
@@ -315,13 +476,6 @@ public:
      */
     bool isOnTheEdge(const Vector2D &P, const Vector2D &A, const Vector2D &B) const ;
 
-    /**
-     * @brief flippIt
-     * Performs a flip operation on this triangle, updating the provided set of triangles as needed.
-     * @param triangles A QVector of Triangles that may be affected by the flip operation.
-     */
-    void flippIt(QVector<Triangle>& triangles);
-
     /**
      * @brief circleContains
      * Checks if a point M is inside or on this triangle's circumcircle.
@@ -330,6 +484,14 @@ public:
      */
     bool circleContains(const Vector2D* M);
 
+    /**
+     * @brief isInCircumcircle
+     * Checks if a point M is strictly inside the circumcircle, whatever the orientation of the triangle.
+     * @param M Pointer to the point being tested.
+     * @return True if M is strictly inside the circumcircle.
+     */
+    bool isInCircumcircle(const Vector2D* M) const;
+
     /**
      * @brief checkDelaunay
      * Updates `isDelaunay` based on whether any point in `tabVertices` lies inside the circumcircle.
@@ -340,7 +502,8 @@ public:
 
     /**
      * @brief updateVertices
-     * Reassigns the 3 vertex pointers (usually used by flipping operations).
+     * Reassigns the 3 vertex pointers (usually used by flipping operations), the caller queues the triangle
+     * for the certification with markDirty().
      * @param _A Pointer to the new first vertex.
      * @param _B Pointer to the new second vertex.
      * @param _C Pointer to the new third vertex.
@@ -360,12 +523,6 @@ public:
      * @param painter A reference to the QPainter on which to draw the circumcircle.
      */
     void drawCircle(QPainter &painter);
-
-    /**
-     * @brief flippIt
-     * Overloaded function (empty body) possibly a placeholder for another flipping operation.
-     */
-    void flippIt();
 };
 
 #endif // TRIANGLE_H
@@ -0,0 +1,82 @@
+#include "viewportindex.h"
+#include <algorithm>
+#include <cmath>
+
+void ViewportIndex::clear() {
+    boxes.clear();
+    cellStart.clear();
+    items.clear();
+    stamps.clear();
+    bounds=QRectF();
+    columns=rows=0;
+}
+
+void ViewportIndex::build(const QVector<QRectF> &p_boxes) {
+    clear();
+    boxes=p_boxes;
+    if (boxes.isEmpty()) return;
+
+    double left=boxes[0].left(),top=boxes[0].top(),right=boxes[0].right(),bottom=boxes[0].bottom();
+    double meanSize=0;
+    for (const QRectF &b:boxes) {
+        left=qMin(left,b.left());
+        top=qMin(top,b.top());
+        right=qMax(right,b.right());
+        bottom=qMax(bottom,b.bottom());
+        meanSize+=qMax(b.width(),b.height());
+    }
+    bounds=QRectF(left,top,right-left,bottom-top);
+    meanSize/=boxes.size();
+
+    // about one cell per item, but not smaller than the items, and at most 1024 cells per side
+    const double extent=qMax(bounds.width(),bounds.height());
+    cellSize=qMax(std::sqrt(bounds.width()*bounds.height()/boxes.size()),meanSize);
+    cellSize=qMax(cellSize,extent/1024);
+    if (cellSize<=0) cellSize=1;
+    columns=int(bounds.width()/cellSize)+1;
+    rows=int(bounds.height()/cellSize)+1;
+
+    // two passes: count the items of each cell, then place them
+    cellStart.fill(0,columns*rows+1);
+    for (const QRectF &b:boxes) {
+        for (int r=row(b.top()); r<=row(b.bottom()); r++) {
+            for (int c=column(b.left()); c<=column(b.right()); c++) cellStart[r*columns+c+1]++;
+        }
+    }
+    for (int k=0; k<columns*rows; k++) cellStart[k+1]+=cellStart[k];
+    items.resize(cellStart.last());
+    QVector<int> fill(cellStart.begin(),cellStart.end()-1);
+    for (int i=0; i<boxes.size(); i++) {
+        const QRectF &b=boxes[i];
+        for (int r=row(b.top()); r<=row(b.bottom()); r++) {
+            for (int c=column(b.left()); c<=column(b.right()); c++) items[fill[r*columns+c]++]=i;
+        }
+    }
+    stamps.fill(0,boxes.size());
+    stamp=0;
+}
+
+void ViewportIndex::query(const QRectF &rect,QVector<int> &result) const {
+    result.clear();
+    if (boxes.isEmpty() || !overlaps(rect,bounds)) return;
+
+    if (++stamp==0) { // wrap around: forget the previous queries
+        stamps.fill(0);
+        stamp=1;
+    }
+    const int c0=column(rect.left()),c1=column(rect.right());
+    for (int r=row(rect.top()); r<=row(rect.bottom()); r++) {
+        for (int c=c0; c<=c1; c++) {
+            const int cell=r*columns+c;
+            for (int k=cellStart[cell]; k<cellStart[cell+1]; k++) {
+                const int i=items[k];
+                if (stamps[i]!=stamp && overlaps(boxes[i],rect)) {
+                    stamps[i]=stamp;
+                    result.append(i);
+                }
+            }
+        }
+    }
+    // keep the drawing order of the items
+    std::sort(result.begin(),result.end());
+}
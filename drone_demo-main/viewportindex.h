@@ -0,0 +1,62 @@
+/**
+ * @file viewportindex.h
+ * @brief Static spatial index of bounding boxes, queried with the visible part of the canvas.
+ */
+#ifndef VIEWPORTINDEX_H
+#define VIEWPORTINDEX_H
+
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @class ViewportIndex
+ * @brief The ViewportIndex class finds the items whose bounding box overlaps a rectangle.
+ *
+ * The boxes are bucketed in a uniform grid of about one cell per item, built at once and stored
+ * as a compact array of item indices per cell. An item overlapping several cells is stored in
+ * each of them, and reported once per query thanks to a stamp per item.
+ * Boxes of null width or height (points, horizontal or vertical segments) are supported.
+ */
+class ViewportIndex {
+public:
+    ViewportIndex() {}
+
+    /**
+     * @brief Index a new set of boxes, the index of an item being its position in boxes
+     */
+    void build(const QVector<QRectF> &p_boxes);
+    /**
+     * @brief Remove all the items
+     */
+    void clear();
+    inline int size() const { return boxes.size(); }
+    /**
+     * @brief Get the union of the boxes (empty if there is no item)
+     */
+    inline const QRectF &getBounds() const { return bounds; }
+
+    /**
+     * @brief Get the items whose box overlaps a rectangle
+     * @param rect query rectangle
+     * @param result indices of the items, in increasing order (its previous content is erased)
+     */
+    void query(const QRectF &rect,QVector<int> &result) const;
+
+private:
+    static inline bool overlaps(const QRectF &a,const QRectF &b) {
+        return a.left()<=b.right() && b.left()<=a.right() && a.top()<=b.bottom() && b.top()<=a.bottom();
+    }
+    inline int column(double x) const { return qBound(0,int((x-bounds.left())/cellSize),columns-1); }
+    inline int row(double y) const { return qBound(0,int((y-bounds.top())/cellSize),rows-1); }
+
+    QVector<QRectF> boxes;   ///< bounding box of each item
+    QRectF bounds;           ///< union of the boxes
+    double cellSize=1;       ///< size of the side of a cell
+    int columns=0,rows=0;    ///< size of the grid
+    QVector<int> cellStart;  ///< position of the first item of each cell in items, and the end
+    QVector<int> items;      ///< indices of the items, grouped by cell
+    mutable QVector<quint32> stamps; ///< last query which reported each item
+    mutable quint32 stamp=0;         ///< number of the current query
+};
+
+#endif // VIEWPORTINDEX_H
@@ -1,4 +1,5 @@
 #include "voronoi.h"
+#include "logging.h"
 #include <QDebug>
 
 Voronoi::Voronoi(const Vector2D& centerPoint) : center(centerPoint) {}
@@ -11,25 +12,20 @@ void Voronoi::generate(const QVector<Triangle>& triangles) {
         if (triangle.contains(center)) {
             // Add edges connecting the circumcenters of neighboring triangles
             for (int i = 0; i < 3; ++i) {
-                const Vector2D* v1 = triangle.getVertexPtr(i);
-                const Vector2D* v2 = triangle.getVertexPtr((i + 1) % 3);
-
-                // Find neighboring triangle sharing this edge
-                for (const Triangle& neighbor : triangles) {
-                    if (&triangle != &neighbor && neighbor.hasEdge(*v1, *v2)) {
-                        QLineF edge(triangle.getCircleCenter().x,
-                                    triangle.getCircleCenter().y,
-                                    neighbor.getCircleCenter().x,
-                                    neighbor.getCircleCenter().y);
-                        edges.append(edge);
-                        break;
-                    }
-                }
+                // Neighboring triangle across the edge (i, i+1)
+                const int n = triangle.getNeighbor((i + 2) % 3);
+                if (n < 0) continue;
+                const Triangle& neighbor = triangles[n];
+                QLineF edge(triangle.getCircleCenter().x,
+                            triangle.getCircleCenter().y,
+                            neighbor.getCircleCenter().x,
+                            neighbor.getCircleCenter().y);
+                edges.append(edge);
             }
         }
     }
 
-    qDebug() << "Generated Voronoi edges for point:" << center.x << center.y
+    qCDebug(lcMesh) << "Generated Voronoi edges for point:" << center.x << center.y
              << "Edges count:" << edges.size();
 }
 
@@ -0,0 +1,124 @@
+#include "workerpool.h"
+
+WorkerPool::WorkerPool(int threadCount) {
+    setThreadCount(threadCount);
+}
+
+WorkerPool::~WorkerPool() {
+    stopThreads();
+}
+
+void WorkerPool::setThreadCount(int n) {
+    if (n<=0) {
+        n=int(std::thread::hardware_concurrency());
+        if (n<=0) n=1;
+    }
+    if (n==getThreadCount() && ranges) return;
+    stopThreads();
+    startThreads(n-1);
+}
+
+void WorkerPool::startThreads(int n) {
+    ranges.reset(new Range[n+1]);
+    stop=false;
+    for (int w=0; w<n; w++) {
+        threads.emplace_back(&WorkerPool::threadLoop,this,w);
+    }
+}
+
+void WorkerPool::stopThreads() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop=true;
+    }
+    startCondition.notify_all();
+    for (auto &t:threads) {
+        t.join();
+    }
+    threads.clear();
+}
+
+int WorkerPool::popFront(int w) {
+    std::atomic<quint64> &r=ranges[w].value;
+    quint64 v=r.load();
+    for (;;) {
+        const quint32 b=quint32(v>>32),e=quint32(v);
+        if (b>=e) return -1;
+        if (r.compare_exchange_weak(v,pack(b+1,e))) return int(b);
+    }
+}
+
+int WorkerPool::popBack(int w) {
+    std::atomic<quint64> &r=ranges[w].value;
+    quint64 v=r.load();
+    for (;;) {
+        const quint32 b=quint32(v>>32),e=quint32(v);
+        if (b>=e) return -1;
+        if (r.compare_exchange_weak(v,pack(b,e-1))) return int(e-1);
+    }
+}
+
+void WorkerPool::work(int w) {
+    const int participants=getThreadCount();
+    for (;;) {
+        int c=popFront(w);
+        // own range is empty: steal from the others
+        for (int k=1; c<0 && k<participants; k++) {
+            c=popBack((w+k)%participants);
+        }
+        if (c<0) return;
+
+        const int begin=c*jobGrain;
+        const int end=qMin(begin+jobGrain,jobSize);
+        (*job)(begin,end);
+        if (pending.fetch_sub(1)==1) {
+            std::lock_guard<std::mutex> lock(mutex);
+            endCondition.notify_all();
+        }
+    }
+}
+
+void WorkerPool::threadLoop(int w) {
+    quint64 seen=0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock,[&] { return stop || generation!=seen; });
+            if (stop) return;
+            seen=generation;
+        }
+        work(w);
+    }
+}
+
+void WorkerPool::parallelFor(int n,int grain,const std::function<void(int,int)> &f) {
+    if (n<=0) return;
+    if (grain<1) grain=1;
+    const int chunks=(n+grain-1)/grain;
+    if (threads.empty() || chunks==1) {
+        f(0,n);
+        return;
+    }
+
+    job=&f;
+    jobSize=n;
+    jobGrain=grain;
+    pending.store(chunks);
+    // even distribution of the chunks, the calling thread is the last participant
+    const int participants=getThreadCount();
+    for (int w=0; w<participants; w++) {
+        const quint32 b=quint32(qint64(chunks)*w/participants);
+        const quint32 e=quint32(qint64(chunks)*(w+1)/participants);
+        ranges[w].value.store(pack(b,e));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        generation++;
+    }
+    startCondition.notify_all();
+
+    work(participants-1);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    endCondition.wait(lock,[&] { return pending.load()==0; });
+}
@@ -0,0 +1,88 @@
+/**
+ * @file workerpool.h
+ * @brief Pool of threads running parallel loops with work stealing.
+ */
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <QVector>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class WorkerPool
+ * @brief The WorkerPool class runs the chunks of a loop on a set of threads.
+ *
+ * The chunks of a loop are first distributed evenly between the participants (the worker
+ * threads and the calling thread). Each participant takes its chunks from the front of its
+ * own range; when it is empty, it steals chunks from the back of the ranges of the others.
+ * A range is a single atomic word, so taking or stealing a chunk is one compare-and-swap.
+ *
+ * The pool does not decide which chunk computes which item: a loop whose items are
+ * independent gives the same result whatever the number of threads.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Constructs a pool
+     * @param threadCount total number of threads running a loop (calling thread included),
+     *        0 to use the number of cores
+     */
+    explicit WorkerPool(int threadCount=0);
+    /**
+     * @brief Stops and joins the worker threads
+     */
+    ~WorkerPool();
+
+    /**
+     * @brief Change the number of threads running a loop (calling thread included)
+     * @param n new number of threads, 0 to use the number of cores
+     */
+    void setThreadCount(int n);
+    /**
+     * @brief Get the number of threads running a loop (calling thread included)
+     */
+    inline int getThreadCount() const { return int(threads.size())+1; }
+
+    /**
+     * @brief Run f(begin,end) on all the chunks of [0,n) and wait for the end of the loop
+     * @param n number of items
+     * @param grain maximum number of items of a chunk
+     * @param f function processing the items from begin to end-1
+     */
+    void parallelFor(int n,int grain,const std::function<void(int,int)> &f);
+
+private:
+    /**
+     * @brief Range of chunks [begin,end) of a participant packed in one atomic word
+     */
+    struct Range {
+        std::atomic<quint64> value{0};
+    };
+
+    static inline quint64 pack(quint32 b,quint32 e) { return (quint64(b)<<32) | e; }
+    int popFront(int w);
+    int popBack(int w);
+    void work(int w);
+    void threadLoop(int w);
+    void startThreads(int n);
+    void stopThreads();
+
+    std::vector<std::thread> threads;            ///< worker threads
+    std::unique_ptr<Range[]> ranges;             ///< chunks remaining for each participant
+    std::mutex mutex;                            ///< protects generation and stop
+    std::condition_variable startCondition;      ///< wakes up the workers for a new loop
+    std::condition_variable endCondition;        ///< wakes up the caller at the end of a loop
+    quint64 generation=0;                        ///< number of loops started
+    bool stop=false;                             ///< true to end the worker threads
+    std::atomic<int> pending{0};                 ///< chunks not processed yet
+    const std::function<void(int,int)> *job=nullptr; ///< function of the current loop
+    int jobSize=0;                               ///< number of items of the current loop
+    int jobGrain=1;                              ///< number of items of a chunk
+};
+
+#endif // WORKERPOOL_H